@@ -0,0 +1,203 @@
+#include "CommandRoutes.h"
+
+#include <array>
+
+#include "scheduler/DispatchTable.h"
+#include "sensors/ADS7828.h"
+#include "sensors/INA219.h"
+#include "sensors/UCamIII.h"
+#include "sensors/ina260.h"
+
+namespace {
+    bool is_bool(uint8_t value) {
+        return value <= 1;
+    }
+
+    struct SnapshotParams {
+        UCamIII::SnapshotType snapshot_type;
+        uint16_t skipped_frames;
+
+        static Status decode(ParamReader& in, SnapshotParams& params) {
+            params.snapshot_type = in.read<UCamIII::SnapshotType>();
+            params.skipped_frames = in.read<uint16_t>();
+            return params.snapshot_type <= UCamIII::SNAP_RAW ? SUCCESS : INVALID_INPUT;
+        }
+    };
+
+    struct DownloadParams {
+        UCamIII::PictureType picture_type;
+        uint8_t jpeg;
+
+        static Status decode(ParamReader& in, DownloadParams& params) {
+            params.picture_type = in.read<UCamIII::PictureType>();
+            params.jpeg = in.read<uint8_t>();
+            bool valid_type = params.picture_type == UCamIII::PIC_SNAPSHOT || params.picture_type == UCamIII::PIC_RAW ||
+                              params.picture_type == UCamIII::PIC_JPEG;
+            return valid_type && is_bool(params.jpeg) ? SUCCESS : INVALID_INPUT;
+        }
+    };
+
+    struct PackageSizeParams {
+        uint16_t size;
+
+        static Status decode(ParamReader& in, PackageSizeParams& params) {
+            params.size = in.read<uint16_t>();
+            return SUCCESS;
+        }
+    };
+
+    struct ResetParams {
+        UCamIII::ResetType reset_type;
+        uint8_t immediate;
+
+        static Status decode(ParamReader& in, ResetParams& params) {
+            params.reset_type = in.read<UCamIII::ResetType>();
+            params.immediate = in.read<uint8_t>();
+            return params.reset_type <= UCamIII::RST_STATE_MACHINES && is_bool(params.immediate) ? SUCCESS : INVALID_INPUT;
+        }
+    };
+
+    struct RunningParams {
+        uint8_t running;
+
+        static Status decode(ParamReader& in, RunningParams& params) {
+            params.running = in.read<uint8_t>();
+            return is_bool(params.running) ? SUCCESS : INVALID_INPUT;
+        }
+    };
+
+    struct ReconfigureParams {
+        INA219::ShuntVoltageRangeSetting range;
+        uint8_t oversampling;
+        uint8_t bus_full_range;
+
+        static Status decode(ParamReader& in, ReconfigureParams& params) {
+            // The enum is int-sized; on the wire it is one byte
+            params.range = static_cast<INA219::ShuntVoltageRangeSetting>(in.read<uint8_t>());
+            params.oversampling = in.read<uint8_t>();
+            params.bus_full_range = in.read<uint8_t>();
+            return params.range <= INA219::PlusMinus_320_mV && params.oversampling <= 7 &&
+                   is_bool(params.bus_full_range) ? SUCCESS : INVALID_INPUT;
+        }
+    };
+
+    struct AlertPinParams {
+        uint8_t alert_pin;
+
+        static Status decode(ParamReader& in, AlertPinParams& params) {
+            params.alert_pin = in.read<uint8_t>();
+            return SUCCESS;
+        }
+    };
+
+    struct NoParams {
+        static Status decode(ParamReader&, NoParams&) {
+            return SUCCESS;
+        }
+    };
+
+    Status camera_snapshot(Drivers& drivers, const SnapshotParams& params, Response&) {
+        if (!drivers.camera) {
+            return FAILURE;
+        }
+        return drivers.camera->snapshot(params.snapshot_type, params.skipped_frames);
+    }
+
+    Status camera_download(Drivers& drivers, const DownloadParams& params, Response&) {
+        if (!drivers.camera) {
+            return FAILURE;
+        }
+
+        uint32_t len;
+        Status status = drivers.camera->get_picture(params.picture_type, len);
+        if (status != SUCCESS) {
+            return status;
+        }
+        if (params.jpeg) {
+            return drivers.camera->write_jpeg_data(len);
+        }
+        drivers.camera->write_raw_data(len);
+        return SUCCESS;
+    }
+
+    Status camera_set_package_size(Drivers& drivers, const PackageSizeParams& params, Response&) {
+        if (!drivers.camera) {
+            return FAILURE;
+        }
+        return drivers.camera->set_package_size(params.size);
+    }
+
+    Status camera_reset(Drivers& drivers, const ResetParams& params, Response&) {
+        if (!drivers.camera) {
+            return FAILURE;
+        }
+        return drivers.camera->soft_reset(params.reset_type, params.immediate);
+    }
+
+    Status adc_set_running(Drivers& drivers, const RunningParams& params, Response&) {
+        if (!drivers.adc) {
+            return FAILURE;
+        }
+        return drivers.adc->setRunning(params.running);
+    }
+
+    Status current_monitor_reconfigure(Drivers& drivers, const ReconfigureParams& params, Response&) {
+        if (!drivers.current_monitor) {
+            return FAILURE;
+        }
+        return drivers.current_monitor->reconfigure(params.range, params.oversampling, params.bus_full_range);
+    }
+
+    Status current_monitor_set_running(Drivers& drivers, const RunningParams& params, Response&) {
+        if (!drivers.current_monitor) {
+            return FAILURE;
+        }
+        return drivers.current_monitor->setRunning(params.running);
+    }
+
+    Status power_monitor_enable_conversion_ready(Drivers& drivers, const AlertPinParams& params, Response&) {
+        if (!drivers.power_monitor) {
+            return FAILURE;
+        }
+        return drivers.power_monitor->enableConversionReady(params.alert_pin);
+    }
+
+    Status power_monitor_disable_conversion_ready(Drivers& drivers, const NoParams&, Response&) {
+        if (!drivers.power_monitor) {
+            return FAILURE;
+        }
+        return drivers.power_monitor->disableConversionReady();
+    }
+
+    constexpr std::array ROUTES{
+        route<&camera_snapshot>(subsystems::CAMERA, routes::CAMERA_SNAPSHOT, resources::UART_0),
+        route<&camera_download>(subsystems::CAMERA, routes::CAMERA_DOWNLOAD, resources::UART_0),
+        route<&camera_set_package_size>(subsystems::CAMERA, routes::CAMERA_SET_PACKAGE_SIZE, resources::UART_0),
+        route<&camera_reset>(subsystems::CAMERA, routes::CAMERA_RESET, resources::UART_0),
+        route<&adc_set_running>(subsystems::ADC, routes::ADC_SET_RUNNING, resources::I2C_1),
+        route<&current_monitor_reconfigure>(subsystems::CURRENT_MONITOR, routes::CURRENT_MONITOR_RECONFIGURE,
+                                            resources::I2C_1),
+        route<&current_monitor_set_running>(subsystems::CURRENT_MONITOR, routes::CURRENT_MONITOR_SET_RUNNING,
+                                            resources::I2C_1),
+        route<&power_monitor_enable_conversion_ready>(subsystems::POWER_MONITOR,
+                                                      routes::POWER_MONITOR_ENABLE_CONVERSION_READY, resources::I2C_1),
+        route<&power_monitor_disable_conversion_ready>(subsystems::POWER_MONITOR,
+                                                       routes::POWER_MONITOR_DISABLE_CONVERSION_READY, resources::I2C_1),
+    };
+
+    constexpr auto TABLE = make_dispatch_table<ROUTES>();
+}
+
+namespace routes {
+    Status check(const Command& cmd) {
+        return TABLE.check(cmd);
+    }
+
+    Response dispatch(Drivers& drivers, const Command& cmd) {
+        return TABLE.dispatch(drivers, cmd);
+    }
+
+    ResourceMask resources(const Command& cmd) {
+        return TABLE.resources(cmd);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef RAPIDCDH_COMMANDROUTES_H
+#define RAPIDCDH_COMMANDROUTES_H
+
+#include <cstdint>
+
+#include "globals.h"
+#include "scheduler/Command.h"
+
+class ADS7828;
+class INA219;
+class UCamIII;
+namespace ina260 {
+    class Ina260;
+}
+
+// Subsystem ids used in Command::subsystem_id
+namespace subsystems {
+    inline constexpr uint8_t CAMERA = 1;
+    inline constexpr uint8_t ADC = 2;
+    inline constexpr uint8_t CURRENT_MONITOR = 3; // INA219
+    inline constexpr uint8_t POWER_MONITOR = 4;   // INA260
+}
+
+// The buses commands declare they use. Commands on different buses run concurrently; commands on the same one are
+// serialized, whichever subsystem they belong to
+namespace resources {
+    inline constexpr ResourceMask I2C_1 = 1u << 0;  // ADS7828, INA219, INA260
+    inline constexpr ResourceMask SPI_0 = 1u << 1;  // UM7
+    inline constexpr ResourceMask UART_0 = 1u << 2; // uCAM-III
+}
+
+// The drivers commands are routed to. A driver left as nullptr answers its commands with FAILURE
+struct Drivers {
+    UCamIII* camera = nullptr;
+    ADS7828* adc = nullptr;
+    INA219* current_monitor = nullptr;
+    ina260::Ina260* power_monitor = nullptr;
+};
+
+// Command numbers within each subsystem, and the params each one takes (little-endian, in order)
+namespace routes {
+    enum CameraCmd : uint8_t {
+        CAMERA_SNAPSHOT,         // snapshot_type u8 (UCamIII::SnapshotType), skipped_frames u16
+        CAMERA_DOWNLOAD,         // picture_type u8 (UCamIII::PictureType), jpeg u8: writes the picture to the output file
+        CAMERA_SET_PACKAGE_SIZE, // size u16
+        CAMERA_RESET,            // reset_type u8 (UCamIII::ResetType), immediate u8
+    };
+
+    enum AdcCmd : uint8_t {
+        ADC_SET_RUNNING, // running u8
+    };
+
+    enum CurrentMonitorCmd : uint8_t {
+        CURRENT_MONITOR_RECONFIGURE,  // range u8 (INA219::ShuntVoltageRangeSetting), oversampling u8 (0-7),
+                                      // bus_full_range u8
+        CURRENT_MONITOR_SET_RUNNING,  // running u8
+    };
+
+    enum PowerMonitorCmd : uint8_t {
+        POWER_MONITOR_ENABLE_CONVERSION_READY,  // alert_pin u8
+        POWER_MONITOR_DISABLE_CONVERSION_READY, // none
+    };
+
+    // SUCCESS if the command is routed and its params are well formed, so it can be queued
+    [[nodiscard]] Status check(const Command& cmd);
+    // Runs the command's handler. Unrouted commands answer CMD_UNKNOWN, malformed params INVALID_INPUT
+    Response dispatch(Drivers& drivers, const Command& cmd);
+    // The buses the command's route uses, for CommandExecutor
+    [[nodiscard]] ResourceMask resources(const Command& cmd);
+}
+
+
+#endif //RAPIDCDH_COMMANDROUTES_H
@@ -0,0 +1,124 @@
+// Throughput of the command/response codec, in packets per second. Run it on the target to size the uplink handler:
+//   ./codec_bench [seconds per case]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../scheduler/Checksum.h"
+#include "../scheduler/Codec.h"
+
+using std::cout;
+using std::endl;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t PACKETS = 4096;
+    constexpr size_t MAX_PAYLOAD = 64;
+    constexpr size_t FRAME_SIZE = 1024; // Downlink frame
+
+    // Keeps the optimizer from discarding results
+    volatile uint64_t sink;
+
+    // Calls op until at least seconds have passed; op returns the number of packets it handled
+    template <typename Op>
+    void measure(const char* name, double seconds, size_t bytes_per_pass, size_t packets_per_pass, Op op) {
+        uint64_t packets = 0;
+        uint64_t passes = 0;
+        Clock::time_point start = Clock::now();
+        Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        Clock::time_point now;
+        do {
+            packets += op();
+            passes++;
+            now = Clock::now();
+        } while (now < end);
+
+        double elapsed = std::chrono::duration<double>(now - start).count();
+        double rate = packets / elapsed;
+        double bandwidth = passes * bytes_per_pass / elapsed / 1e6;
+        cout << name << ": " << static_cast<uint64_t>(rate) << " packets/s, " << bandwidth << " MB/s ("
+             << packets_per_pass << " packets per pass)" << endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> byte(0, 255);
+    std::uniform_int_distribution<uint16_t> payload_len(0, MAX_PAYLOAD);
+
+    // A receive buffer of back-to-back command packets with random payloads
+    std::vector<uint8_t> params(MAX_PAYLOAD);
+    std::vector<uint8_t> rx(PACKETS * (codec::COMMAND_HEADER_SIZE + MAX_PAYLOAD));
+    size_t rx_len = 0;
+    for (size_t i = 0; i < PACKETS; i++) {
+        for (uint8_t& b : params) {
+            b = byte(rng);
+        }
+        Command cmd{static_cast<CommandId>(i), static_cast<uint8_t>(byte(rng)), static_cast<uint8_t>(byte(rng)),
+                    payload_len(rng), params.data(), 1000 * i, 30, 0};
+        cmd.checksum = checksum::command_checksum(cmd);
+        size_t written;
+        if (codec::encode_command(cmd, std::span(rx).subspan(rx_len), written) != SUCCESS) {
+            return 1;
+        }
+        rx_len += written;
+    }
+    std::span<uint8_t> received(rx.data(), rx_len);
+
+    std::vector<Command> commands(PACKETS);
+    measure("decode", seconds, rx_len, PACKETS, [&]() {
+        size_t count, consumed;
+        codec::decode_commands(received, commands, count, consumed);
+        sink = consumed;
+        return count;
+    });
+
+    measure("decode + verify", seconds, rx_len, PACKETS, [&]() {
+        size_t count, consumed;
+        codec::decode_commands(received, commands, count, consumed);
+        sink = checksum::verify_commands(std::span<const Command>(commands.data(), count));
+        return count;
+    });
+
+    // Responses carrying the same payloads, packed into downlink frames
+    std::vector<Response> responses(PACKETS);
+    size_t response_bytes = 0;
+    for (size_t i = 0; i < PACKETS; i++) {
+        const Command& cmd = commands[i];
+        responses[i] = {cmd.subsystem_id, cmd.cmd_id, SUCCESS, cmd.params_len, cmd.params, 0};
+        response_bytes += codec::encoded_size(responses[i]);
+    }
+    checksum::stamp_responses(responses);
+
+    std::vector<uint8_t> frame(FRAME_SIZE);
+    measure("encode", seconds, response_bytes, PACKETS, [&]() {
+        std::span<const Response> remaining(responses);
+        while (!remaining.empty()) {
+            size_t count, written;
+            codec::encode_responses(remaining, frame, count, written);
+            sink = written;
+            remaining = remaining.subspan(count);
+        }
+        return PACKETS;
+    });
+
+    measure("stamp + encode", seconds, response_bytes, PACKETS, [&]() {
+        checksum::stamp_responses(responses);
+        std::span<const Response> remaining(responses);
+        while (!remaining.empty()) {
+            size_t count, written;
+            codec::encode_responses(remaining, frame, count, written);
+            sink = written;
+            remaining = remaining.subspan(count);
+        }
+        return PACKETS;
+    });
+
+    return 0;
+}
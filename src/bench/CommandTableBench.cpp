@@ -0,0 +1,122 @@
+// CommandTable against the node-based std::unordered_map that CommandScheduler used before, in nanoseconds per operation:
+//   ./command_table_bench [operations per case]
+//
+// Each case fills the table to a number of pending commands and then churns it the way a scheduler does: look up a
+// pending id, remove one, and add a new one with a recycled number.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "../scheduler/CommandTable.h"
+
+using std::cout;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // What the old map stored per command, so that node allocations are the same size they were
+    struct MapEntry {
+        Command cmd;
+        uint64_t seq;
+        size_t heap_pos;
+        uint32_t wheel_handle;
+    };
+
+    // Adapts both containers to the same three operations
+    struct FlatTable {
+        explicit FlatTable(size_t capacity) : table(capacity) {}
+
+        bool insert(CommandId id, uint32_t value) {
+            return table.insert(id, value) == SUCCESS;
+        }
+
+        bool find(CommandId id, uint32_t& value) const {
+            return table.find(id, value) == SUCCESS;
+        }
+
+        bool erase(CommandId id) {
+            return table.erase(id) == SUCCESS;
+        }
+
+        CommandTable table;
+    };
+
+    struct NodeMap {
+        explicit NodeMap(size_t) {}
+
+        bool insert(CommandId id, uint32_t value) {
+            return map.try_emplace(id, MapEntry{{id}, value, 0, 0}).second;
+        }
+
+        bool find(CommandId id, uint32_t& value) const {
+            auto it = map.find(id);
+            if (it == map.end()) {
+                return false;
+            }
+            value = static_cast<uint32_t>(it->second.seq);
+            return true;
+        }
+
+        bool erase(CommandId id) {
+            return map.erase(id) > 0;
+        }
+
+        std::unordered_map<CommandId, MapEntry> map;
+    };
+
+    volatile uint32_t sink;
+
+    template <typename Table>
+    void run(const char* name, size_t pending, size_t operations) {
+        Table table(pending);
+        std::mt19937 rng(1);
+
+        // ids[i] is the id currently using number i
+        std::vector<CommandId> ids(pending);
+        for (uint32_t i = 0; i < pending; i++) {
+            ids[i] = make_cmd_id(0, i);
+            table.insert(ids[i], i);
+        }
+        std::vector<uint32_t> picks(operations);
+        for (uint32_t& pick : picks) {
+            pick = rng() % pending;
+        }
+
+        uint32_t found = 0;
+        Clock::time_point start = Clock::now();
+        for (uint32_t pick : picks) {
+            uint32_t value;
+            found += table.find(ids[pick], value) ? value : 0;
+        }
+        double find_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / operations;
+
+        start = Clock::now();
+        for (uint32_t pick : picks) {
+            table.erase(ids[pick]);
+            ids[pick] = make_cmd_id(cmd_generation(ids[pick]) + 1, pick);
+            table.insert(ids[pick], pick);
+        }
+        double churn_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / operations;
+        sink = found;
+
+        cout << std::left << std::setw(16) << name << std::right << std::setw(6) << pending << " pending:  find "
+             << std::fixed << std::setprecision(1) << std::setw(6) << find_ns << " ns,  remove + add " << std::setw(6)
+             << churn_ns << " ns\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t operations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    for (size_t pending : {64, 256, 4096}) {
+        run<FlatTable>("CommandTable", pending, operations);
+        run<NodeMap>("unordered_map", pending, operations);
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Throughput of the batch sensor conversions against a per-sample loop, in samples per second and MB/s moved (two
+// bytes read and four written per sample). The large buffer does not fit in cache, so it shows how close the batch
+// kernels come to memory bandwidth; the small one shows their compute rate:
+//   ./conversion_bench [seconds per case]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../sensors/Conversion.h"
+#include "../sensors/LookupTable.h"
+
+using std::cout;
+using std::endl;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t SMALL = 4096;
+    constexpr size_t LARGE = 1 << 24; // A day of one channel at about 200 Hz
+
+    // Keeps the optimizer from discarding results
+    volatile float sink;
+
+    // Calls op until at least seconds have passed; op converts samples values per call
+    template <typename Op>
+    void measure(const char* name, double seconds, size_t samples, Op op) {
+        uint64_t passes = 0;
+        Clock::time_point start = Clock::now();
+        Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        Clock::time_point now;
+        do {
+            op();
+            passes++;
+            now = Clock::now();
+        } while (now < end);
+
+        double elapsed = std::chrono::duration<double>(now - start).count();
+        double rate = passes * samples / elapsed;
+        cout << name << ": " << static_cast<uint64_t>(rate) << " samples/s, " << rate * 6 / 1e6 << " MB/s" << endl;
+    }
+
+    void run(size_t samples, double seconds) {
+        std::mt19937 rng(1);
+        std::vector<uint16_t> raw(samples);
+        for (uint16_t& r : raw) {
+            r = static_cast<uint16_t>(rng() & 0xfff);
+        }
+        std::vector<float> out(samples);
+
+        cout << samples << " samples" << endl;
+        conversion::Linear current{.scale = 0.0122f, .is_signed = true};
+        measure("  linear, per sample", seconds, samples, [&]() {
+            for (size_t i = 0; i < samples; i++) {
+                out[i] = static_cast<float>(static_cast<int16_t>(raw[i]) * static_cast<double>(current.scale));
+            }
+            sink = out[samples / 2];
+        });
+        measure("  linear, batch", seconds, samples, [&]() {
+            conversion::convert(raw, current, out);
+            sink = out[samples / 2];
+        });
+
+        conversion::Reciprocal rtd{1234.5f, -259.7f};
+        measure("  reciprocal, per sample", seconds, samples, [&]() {
+            for (size_t i = 0; i < samples; i++) {
+                out[i] = static_cast<float>(rtd.scale / static_cast<double>(raw[i]) + rtd.offset);
+            }
+            sink = out[samples / 2];
+        });
+        measure("  reciprocal, batch", seconds, samples, [&]() {
+            conversion::convert(raw, rtd, out);
+            sink = out[samples / 2];
+        });
+
+        // The same curve as a table, as PPG102A6 and TMP36 convert
+        constexpr conversion::LookupTable table([](double code) { return code > 0 ? 1234.5 / code - 259.7 : 0.0; });
+        measure("  table, batch", seconds, samples, [&]() {
+            conversion::convert(raw, table, out);
+            sink = out[samples / 2];
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+
+    run(SMALL, seconds);
+    run(LARGE, seconds);
+
+    return 0;
+}
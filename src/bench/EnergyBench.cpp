@@ -0,0 +1,117 @@
+// Cost of EnergyAccumulator::add_sample and since, and a check of since against totals worked out by hand:
+//   ./energy_bench [seconds per case]
+//
+// The check feeds a constant 100 mA rail with 1 s checkpoints and 10 of history, including samples that repeat the
+// previous timestamp on a checkpoint boundary, which add_sample accepts, and a gap longer than the history. It prints
+// each query with the expected charge and exits non-zero if any disagrees.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "../globals.h"
+#include "../sensors/EnergyAccumulator.h"
+#include "Histogram.h"
+
+using std::cout;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint64_t SECOND_US = 1000000;
+
+    // Keeps the optimizer from discarding results
+    volatile double sink;
+
+    uint64_t elapsed_ns(Clock::time_point since) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+    }
+
+    // Samples one rail at 1 kHz of simulated time, as fast as add_sample takes them, querying the last minute every
+    // simulated second
+    void run(double seconds) {
+        EnergyAccumulator accumulator(1);
+        Histogram add_ns;
+        Histogram since_ns;
+        uint64_t time_us = 0;
+        Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(seconds));
+        while (Clock::now() < end) {
+            Clock::time_point before = Clock::now();
+            (void) accumulator.add_sample(0, time_us, 100.0 + time_us % 7, 500.0);
+            add_ns.record(elapsed_ns(before));
+
+            if (time_us % SECOND_US == 0 && time_us >= 60 * SECOND_US) {
+                EnergyAccumulator::Totals totals;
+                before = Clock::now();
+                (void) accumulator.since(0, time_us - 60 * SECOND_US, totals);
+                since_ns.record(elapsed_ns(before));
+                sink = totals.charge_mAh;
+            }
+            time_us += 1000;
+        }
+
+        add_ns.print(cout, "add_sample", "ns");
+        since_ns.print(cout, "since, last minute", "ns");
+    }
+
+    // One query against its expected outcome; returns false if it disagrees
+    bool expect(const EnergyAccumulator& accumulator, uint64_t since_s, Status status, double charge_mAh,
+                uint64_t from_s) {
+        EnergyAccumulator::Totals totals{};
+        Status got = accumulator.since(0, since_s * SECOND_US, totals);
+        bool ok = got == status &&
+                  (status != SUCCESS ||
+                   (std::abs(totals.charge_mAh - charge_mAh) < 1e-9 && totals.from_us == from_s * SECOND_US));
+        cout << "  since " << since_s << " s: status " << got;
+        if (got == SUCCESS) {
+            cout << ", " << totals.charge_mAh << " mAh from " << totals.from_us / SECOND_US << " s";
+        }
+        cout << (ok ? "" : "  MISMATCH") << '\n';
+        return ok;
+    }
+
+    bool check() {
+        cout << "since, 100 mA, 1 s checkpoints, 10 of history\n";
+        constexpr double MAH_PER_SECOND = 100.0 / 3600;
+        bool ok = true;
+
+        // A repeat of the first sample, on boundary 0
+        EnergyAccumulator origin(1, SECOND_US, 10);
+        for (uint64_t t : {0, 0, 1, 2, 3, 4, 5}) {
+            (void) origin.add_sample(0, t * SECOND_US, 100, 0);
+        }
+        ok &= expect(origin, 2, SUCCESS, 3 * MAH_PER_SECOND, 2);
+
+        // A repeat on boundary 15, among samples 5 s apart, then on into the history
+        EnergyAccumulator repeat(1, SECOND_US, 10, 10 * SECOND_US);
+        for (uint64_t t : {0, 5, 10, 15, 15, 20, 21}) {
+            (void) repeat.add_sample(0, t * SECOND_US, 100, 0);
+        }
+        ok &= expect(repeat, 12, SUCCESS, 11 * MAH_PER_SECOND, 10);
+        ok &= expect(repeat, 15, SUCCESS, 6 * MAH_PER_SECOND, 15);
+        ok &= expect(repeat, 20, SUCCESS, MAH_PER_SECOND, 20);
+
+        // A gap longer than the history, which is left out of the totals; boundaries within the history of its end
+        // start from the sample before it
+        EnergyAccumulator gap(1, SECOND_US, 10);
+        for (uint64_t t : {0, 1, 1000, 1001, 1002}) {
+            (void) gap.add_sample(0, t * SECOND_US, 100, 0);
+        }
+        ok &= expect(gap, 1000, SUCCESS, 2 * MAH_PER_SECOND, 1000);
+        ok &= expect(gap, 995, SUCCESS, 2 * MAH_PER_SECOND, 1);
+        ok &= expect(gap, 985, INVALID_INPUT, 0, 0);
+
+        return ok;
+    }
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+
+    bool ok = check();
+    run(seconds);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#ifndef RAPIDCDH_HISTOGRAM_H
+#define RAPIDCDH_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+// Log-linear histogram in the style of HdrHistogram: every power of two is split into SUB_BUCKETS equal buckets, so
+// any recorded value is reported to within 1/SUB_BUCKETS of itself, from 0 up to 2^64. Recording never allocates
+class Histogram {
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 4;
+    static constexpr uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    void record(uint64_t value) {
+        m_counts[bucket(value)]++;
+        m_count++;
+        m_min = std::min(m_min, value);
+        m_max = std::max(m_max, value);
+        m_sum += value;
+    }
+
+    void merge(const Histogram& other) {
+        for (size_t i = 0; i < BUCKETS; i++) {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_count += other.m_count;
+        m_min = std::min(m_min, other.m_min);
+        m_max = std::max(m_max, other.m_max);
+        m_sum += other.m_sum;
+    }
+
+    // Upper bound of the bucket holding the given fraction of values, clamped to the largest value seen
+    [[nodiscard]] uint64_t percentile(double fraction) const {
+        if (m_count == 0) {
+            return 0;
+        }
+
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * m_count + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            seen += m_counts[i];
+            if (seen >= rank) {
+                return std::min(upper_bound(i), m_max);
+            }
+        }
+        return m_max;
+    }
+
+    [[nodiscard]] uint64_t count() const {
+        return m_count;
+    }
+
+    // One line: count, mean and percentiles, in the given unit
+    void print(std::ostream& out, const char* name, const char* unit) const {
+        out << std::left << std::setw(24) << name << std::right << " n=" << std::setw(8) << m_count;
+        if (m_count == 0) {
+            out << '\n';
+            return;
+        }
+        out << "  min " << std::setw(7) << m_min << "  mean " << std::setw(7) << m_sum / m_count
+            << "  p50 " << std::setw(7) << percentile(0.5) << "  p90 " << std::setw(7) << percentile(0.9)
+            << "  p99 " << std::setw(7) << percentile(0.99) << "  p99.9 " << std::setw(7) << percentile(0.999)
+            << "  max " << std::setw(7) << m_max << ' ' << unit << '\n';
+    }
+
+private:
+    static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    // Values below SUB_BUCKETS get a bucket each; above that, the top SUB_BUCKET_BITS + 1 bits pick the bucket
+    static size_t bucket(uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return value;
+        }
+        uint32_t magnitude = std::bit_width(value) - SUB_BUCKET_BITS - 1;
+        return (magnitude + 1) * SUB_BUCKETS + ((value >> magnitude) - SUB_BUCKETS);
+    }
+
+    static uint64_t upper_bound(size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        uint32_t magnitude = index / SUB_BUCKETS - 1;
+        uint64_t sub = index % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub + 1) << magnitude) - 1;
+    }
+
+    std::array<uint64_t, BUCKETS> m_counts{};
+    uint64_t m_count = 0;
+    uint64_t m_min = UINT64_MAX;
+    uint64_t m_max = 0;
+    uint64_t m_sum = 0;
+};
+
+
+#endif //RAPIDCDH_HISTOGRAM_H
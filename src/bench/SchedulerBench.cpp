@@ -0,0 +1,339 @@
+// Latency of CommandScheduler under synthetic time-tagged workloads, run in real time against the steady clock:
+//   ./scheduler_bench [seconds per run]
+//
+// For each backend and workload it reports how long add_command and remove_command take, and how late each command is
+// dispatched compared with its exec_time. Lateness includes the time the loop spends asleep past the deadline, so it
+// shows what a dispatch loop on this machine actually achieves. Then, in simulated time, each backend holds 1k, 10k and
+// 100k commands pending while it adds, cancels and dispatches, to show how the costs grow with the pending count.
+// A last run times submit_command from several threads.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../scheduler/CommandScheduler.h"
+#include "Histogram.h"
+
+using std::cout;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    enum Workload {
+        UNIFORM, // One command a millisecond, due 1-200 ms later
+        BURSTY,  // 64 commands every 100 ms, all due within the same 4 ms
+        CANCEL,  // Two commands a millisecond, due 10-100 ms later, three quarters of them cancelled before then
+    };
+
+    const char* workload_name(Workload workload) {
+        switch (workload) {
+            case UNIFORM:
+                return "uniform";
+            case BURSTY:
+                return "bursty";
+            case CANCEL:
+                return "heavy cancellation";
+        }
+        return "";
+    }
+
+    const char* backend_name(CommandScheduler::Backend backend) {
+        return backend == CommandScheduler::HEAP ? "heap" : "timing wheel";
+    }
+
+    uint64_t elapsed_ns(Clock::time_point since) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+    }
+
+    // Command numbers that are free to use, and the pending ids in a form that allows picking one at random to cancel.
+    // Each number's generation is bumped when it is reused, as the ground does
+    class IdSet {
+    public:
+        explicit IdSet(size_t capacity) : m_index(capacity), m_generations(capacity) {
+            for (size_t i = 0; i < capacity; i++) {
+                m_free.push_back(static_cast<uint32_t>(capacity - 1 - i));
+            }
+        }
+
+        bool take(CommandId& cmd_id) {
+            if (m_free.empty()) {
+                return false;
+            }
+            uint32_t number = m_free.back();
+            m_free.pop_back();
+            cmd_id = make_cmd_id(++m_generations[number], number);
+            m_index[number] = m_pending.size();
+            m_pending.push_back(cmd_id);
+            return true;
+        }
+
+        void give_back(CommandId cmd_id) {
+            size_t index = m_index[cmd_number(cmd_id)];
+            m_pending[index] = m_pending.back();
+            m_index[cmd_number(m_pending[index])] = index;
+            m_pending.pop_back();
+            m_free.push_back(cmd_number(cmd_id));
+        }
+
+        [[nodiscard]] bool any_pending() const {
+            return !m_pending.empty();
+        }
+
+        CommandId pick(std::mt19937& rng) const {
+            return m_pending[std::uniform_int_distribution<size_t>(0, m_pending.size() - 1)(rng)];
+        }
+
+    private:
+        std::vector<uint32_t> m_free;
+        std::vector<CommandId> m_pending;
+        std::vector<size_t> m_index;
+        std::vector<uint32_t> m_generations;
+    };
+
+    void run(CommandScheduler::Backend backend, Workload workload, double seconds) {
+        Histogram add_ns;
+        Histogram cancel_ns;
+        Histogram lateness_us;
+        IdSet ids(CommandScheduler::DEFAULT_CAPACITY);
+        uint64_t dropped = 0; // Adds skipped because every id was in use
+
+        Clock::time_point start = Clock::now();
+        CommandScheduler scheduler([&](const Command& cmd) {
+            uint64_t now_us = elapsed_ns(start) / 1000;
+            uint64_t due_us = cmd.exec_time * 1000;
+            lateness_us.record(now_us > due_us ? now_us - due_us : 0);
+            ids.give_back(cmd.cmd_id);
+        }, backend);
+
+        std::mt19937 rng(1);
+        auto add = [&](uint64_t exec_time) {
+            CommandId cmd_id;
+            if (!ids.take(cmd_id)) {
+                dropped++;
+                return;
+            }
+            Command cmd{cmd_id, static_cast<uint8_t>(cmd_id % 8), 0, 0, nullptr, exec_time, 0, 0};
+            Clock::time_point before = Clock::now();
+            Status status = scheduler.add_command(cmd);
+            add_ns.record(elapsed_ns(before));
+            if (status != SUCCESS) {
+                ids.give_back(cmd_id);
+            }
+        };
+        auto cancel = [&]() {
+            CommandId cmd_id = ids.pick(rng);
+            Clock::time_point before = Clock::now();
+            Status status = scheduler.remove_command(cmd_id);
+            cancel_ns.record(elapsed_ns(before));
+            if (status == SUCCESS) {
+                ids.give_back(cmd_id);
+            }
+        };
+
+        uint64_t end_ms = static_cast<uint64_t>(seconds * 1000);
+        uint64_t generated_ms = 0; // Workload generated for every millisecond before this
+        while (true) {
+            uint64_t now_ms = elapsed_ns(start) / 1000000;
+            for (; generated_ms <= now_ms && generated_ms < end_ms; generated_ms++) {
+                uint64_t t = generated_ms;
+                switch (workload) {
+                    case UNIFORM:
+                        add(t + std::uniform_int_distribution<uint64_t>(1, 200)(rng));
+                        break;
+                    case BURSTY:
+                        if (t % 100 == 0) {
+                            for (size_t i = 0; i < 64; i++) {
+                                add(t + 50 + std::uniform_int_distribution<uint64_t>(0, 3)(rng));
+                            }
+                        }
+                        break;
+                    case CANCEL:
+                        for (size_t i = 0; i < 2; i++) {
+                            add(t + std::uniform_int_distribution<uint64_t>(10, 100)(rng));
+                            if (ids.any_pending() && std::uniform_int_distribution<int>(0, 3)(rng) != 0) {
+                                cancel();
+                            }
+                        }
+                        break;
+                }
+            }
+
+            scheduler.run_until(now_ms);
+
+            uint64_t next;
+            bool pending = scheduler.next_deadline(next) == SUCCESS;
+            if (generated_ms >= end_ms && !pending) {
+                break;
+            }
+            // Sleep until the next command is due or the workload generates more, whichever is first
+            if (generated_ms < end_ms) {
+                next = pending ? std::min(next, generated_ms) : generated_ms;
+            }
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(next));
+        }
+
+        cout << backend_name(backend) << ", " << workload_name(workload);
+        if (dropped > 0) {
+            cout << " (" << dropped << " adds skipped, all ids in use)";
+        }
+        cout << '\n';
+        add_ns.print(cout, "  add", "ns");
+        cancel_ns.print(cout, "  cancel", "ns");
+        lateness_us.print(cout, "  dispatch lateness", "us");
+    }
+
+    // Keeps pending commands pending, spread over pending / 8 ms so that about eight fall due each millisecond, while
+    // simulated time advances 1 ms per step: each step dispatches what is due, tops the schedule back up and cancels
+    // and replaces one command at random. Dispatch is the cost of run_until per command it dispatched
+    void run_pending(CommandScheduler::Backend backend, size_t pending, double seconds) {
+        Histogram add_ns;
+        Histogram cancel_ns;
+        Histogram dispatch_ns;
+        IdSet ids(pending + 1);
+        CommandScheduler scheduler([&](const Command& cmd) { ids.give_back(cmd.cmd_id); }, backend,
+                                   PayloadPool::default_classes(), pending + 1);
+
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<uint64_t> delay(1, std::max<uint64_t>(pending / 8, 1));
+        uint64_t now = 0;
+        auto add = [&](Histogram* latency) {
+            CommandId cmd_id;
+            if (!ids.take(cmd_id)) {
+                return;
+            }
+            Command cmd{cmd_id, static_cast<uint8_t>(cmd_id % 8), 0, 0, nullptr, now + delay(rng), 0, 0};
+            Clock::time_point before = Clock::now();
+            Status status = scheduler.add_command(cmd);
+            if (latency) {
+                latency->record(elapsed_ns(before));
+            }
+            if (status != SUCCESS) {
+                ids.give_back(cmd_id);
+            }
+        };
+        while (scheduler.pending() < pending) {
+            add(nullptr);
+        }
+
+        Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(seconds));
+        while (Clock::now() < end) {
+            now++;
+            Clock::time_point before = Clock::now();
+            size_t dispatched = scheduler.run_until(now);
+            if (dispatched > 0) {
+                dispatch_ns.record(elapsed_ns(before) / dispatched);
+            }
+            while (scheduler.pending() < pending) {
+                add(&add_ns);
+            }
+
+            CommandId cmd_id = ids.pick(rng);
+            before = Clock::now();
+            Status status = scheduler.remove_command(cmd_id);
+            cancel_ns.record(elapsed_ns(before));
+            if (status == SUCCESS) {
+                ids.give_back(cmd_id);
+            }
+            add(&add_ns);
+        }
+
+        cout << backend_name(backend) << ", " << pending << " pending\n";
+        add_ns.print(cout, "  add", "ns");
+        cancel_ns.print(cout, "  cancel", "ns");
+        dispatch_ns.print(cout, "  dispatch", "ns");
+    }
+
+    // Producers hammer submit_command while the dispatch thread drains and dispatches as fast as it can
+    void run_submissions(size_t producers, double seconds) {
+        CommandScheduler scheduler;
+        std::atomic<bool> stop = false;
+        std::vector<Histogram> submit_ns(producers);
+        std::vector<uint64_t> full(producers);
+        std::vector<uint64_t> no_payload(producers);
+
+        // Each producer numbers its commands within a range of its own, moving to the next generation each time
+        // round, so no two commands in flight share an id
+        constexpr uint32_t RANGE = CommandScheduler::DEFAULT_CAPACITY / 4;
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; p++) {
+            threads.emplace_back([&, p]() {
+                for (uint32_t k = 0; !stop.load(std::memory_order_relaxed); k++) {
+                    // Params come from the pool on the producer's own thread, as a command decoded off a link would
+                    uint8_t* params;
+                    if (scheduler.allocate_payload(16, params) != SUCCESS) {
+                        no_payload[p]++;
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    std::memset(params, static_cast<int>(p), 16);
+                    Command cmd{make_cmd_id(k / RANGE, static_cast<uint32_t>(p) * RANGE + k % RANGE),
+                                static_cast<uint8_t>(p), 0, 16, params, 0, 0, 0};
+                    Clock::time_point before = Clock::now();
+                    Status status = scheduler.submit_command(cmd);
+                    submit_ns[p].record(elapsed_ns(before));
+                    if (status != SUCCESS) {
+                        // The queue did not take it, so the payload is still ours
+                        scheduler.release_payload(params);
+                        full[p]++;
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(seconds));
+        uint64_t dispatched = 0;
+        while (Clock::now() < end) {
+            dispatched += scheduler.run_until(1);
+        }
+        stop = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        Histogram merged;
+        uint64_t total_full = 0;
+        uint64_t total_no_payload = 0;
+        for (size_t p = 0; p < producers; p++) {
+            merged.merge(submit_ns[p]);
+            total_full += full[p];
+            total_no_payload += no_payload[p];
+        }
+        cout << "submit_command, " << producers << " producer" << (producers > 1 ? "s" : "") << ": "
+             << static_cast<uint64_t>(dispatched / seconds) << " dispatched/s, " << scheduler.rejected_submissions()
+             << " rejected, " << total_full << " found the queue full, " << total_no_payload
+             << " found the pool empty\n";
+        merged.print(cout, "  submit", "ns");
+    }
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+
+    for (CommandScheduler::Backend backend : {CommandScheduler::HEAP, CommandScheduler::TIMING_WHEEL}) {
+        for (Workload workload : {UNIFORM, BURSTY, CANCEL}) {
+            run(backend, workload, seconds);
+        }
+    }
+
+    for (size_t pending : {size_t{1000}, size_t{10000}, size_t{100000}}) {
+        for (CommandScheduler::Backend backend : {CommandScheduler::HEAP, CommandScheduler::TIMING_WHEEL}) {
+            run_pending(backend, pending, seconds);
+        }
+    }
+
+    for (size_t producers = 1; producers <= 4; producers++) {
+        run_submissions(producers, seconds);
+    }
+
+    return 0;
+}
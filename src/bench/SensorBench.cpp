@@ -0,0 +1,318 @@
+// Throughput and latency of the sensor drivers against simulated devices, so the sensor stack can be measured on any
+// machine. Only built with -DRAPIDCDH_SIMULATION=ON:
+//   ./sensor_bench [seconds per case] [overhead per transfer, us]
+//
+// Each case runs at 100 kHz and 400 kHz I2C. The simulated buses take as long as the bits on the wire plus the given
+// per-transfer overhead, which stands in for the syscall and driver; measure it on the target and pass it in to get
+// numbers that predict the real stack. One case reads four INA219s from four threads to show how much of the
+// traffic the bus merges into shared transfers, and the last polls the same four as one rail group at different
+// rates. The INA219 cases compare blind reads with conversion-ready streaming, which reads each conversion once.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../globals.h"
+#include "../sensors/ADS7828.h"
+#include "../sensors/I2CBus.h"
+#include "../sensors/INA219.h"
+#include "../sensors/INA219RailGroup.h"
+#include "../sensors/UM7.h"
+#include "../sensors/ina260.h"
+#include "../sim/SimADS7828.h"
+#include "../sim/SimI2CBackend.h"
+#include "../sim/SimINA219.h"
+#include "../sim/SimINA260.h"
+#include "../sim/SimSpiBackend.h"
+#include "../sim/SimUM7.h"
+#include "Histogram.h"
+
+using std::cout;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint8_t INA260_ADDRESS = 0x45;
+    constexpr int INA260_ALERT_PIN = 6;
+    constexpr uint32_t UM7_SPI_SPEED = 1000000;
+
+    // Keeps the optimizer from discarding results
+    volatile double sink;
+
+    // Calls op until at least seconds have passed, recording how long each call takes. op returns false on failure
+    template <typename Op>
+    void measure(const char* name, double seconds, Op op) {
+        Histogram latency;
+        uint64_t failures = 0;
+        Clock::time_point start = Clock::now();
+        Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        Clock::time_point now = start;
+        while (now < end) {
+            Clock::time_point before = now;
+            failures += !op();
+            now = Clock::now();
+            latency.record(std::chrono::duration_cast<std::chrono::microseconds>(now - before).count());
+        }
+
+        double elapsed = std::chrono::duration<double>(now - start).count();
+        latency.print(cout, name, "us");
+        cout << std::string(24, ' ') << "   " << static_cast<uint64_t>(latency.count() / elapsed) << " reads/s";
+        if (failures > 0) {
+            cout << ", " << failures << " failed";
+        }
+        cout << '\n';
+    }
+
+    void run_i2c(uint32_t clock_hz, double seconds, std::chrono::nanoseconds overhead) {
+        cout << "\nI2C at " << clock_hz / 1000 << " kHz\n";
+
+        auto backend = std::make_unique<SimI2CBackend>(SimI2CBackend::Config{clock_hz, overhead});
+        auto adc = std::make_shared<SimADS7828>();
+        std::array<std::shared_ptr<SimINA219>, 4> monitors;
+        for (size_t i = 0; i < monitors.size(); i++) {
+            monitors[i] = std::make_shared<SimINA219>(i + 1);
+            monitors[i]->set_shunt_voltage(0.012);
+            monitors[i]->set_bus_voltage(5.0);
+            monitors[i]->set_noise(20e-6, 4e-3);
+            backend->attach(static_cast<uint8_t>(0x40 + i), monitors[i]);
+        }
+        auto ina260 = std::make_shared<SimINA260>();
+        ina260->set_current(0.5);
+        ina260->set_bus_voltage(3.3);
+        backend->attach(0x48, adc);
+        backend->attach(INA260_ADDRESS, ina260);
+        ina260->set_alert_pin(INA260_ALERT_PIN);
+        for (int channel = 0; channel < 8; channel++) {
+            adc->set_voltage(channel, 0.25 * (channel + 1));
+        }
+        adc->set_noise(1e-3);
+
+        // The drivers open the bus by path, so they all land on the simulated one
+        std::shared_ptr<I2CBus> bus = I2CBus::attach(constants::I2C_DEV_1, std::move(backend));
+
+        ADS7828 ads7828(constants::I2C_DEV_1, false, false);
+        std::vector<std::unique_ptr<INA219>> ina219s;
+        for (int i = 0; i < 4; i++) {
+            ina219s.push_back(std::make_unique<INA219>(constants::I2C_DEV_1, static_cast<INA219::AddrSelect>(i),
+                                                       INA219::GND, 0.1));
+            if (ina219s.back()->init() != SUCCESS) {
+                cout << "INA219 setup failed\n";
+                return;
+            }
+        }
+        ina260::Ina260 ina(INA260_ADDRESS);
+        if (ina.init() != SUCCESS) {
+            cout << "INA260 setup failed\n";
+            return;
+        }
+
+        int channel = 0;
+        measure("ads7828 channel", seconds, [&]() {
+            uint16_t raw;
+            Status s = ads7828.readChannelCommonAnodeRaw(channel, raw); // A new channel each time: write and read
+            channel = (channel + 1) % 8;
+            sink = raw;
+            return s == SUCCESS;
+        });
+
+        std::array<uint16_t, 8> scan;
+        measure("ads7828 8-channel scan", seconds, [&]() {
+            Status s = ads7828.scanChannels(0xFF, scan);
+            sink = scan[7];
+            return s == SUCCESS;
+        });
+
+        measure("ina219 current", seconds, [&]() {
+            double value;
+            Status s = ina219s[0]->getCurrent_mA(value);
+            sink = value;
+            return s == SUCCESS;
+        });
+
+        measure("ina219 supply voltage", seconds, [&]() {
+            double value;
+            Status s = ina219s[0]->getSupplyVoltage_mV(value);
+            sink = value;
+            return s == SUCCESS;
+        });
+
+        measure("ina219 supply power", seconds, [&]() {
+            double value;
+            Status s = ina219s[0]->getSupplyPower_mW(value);
+            sink = value;
+            return s == SUCCESS;
+        });
+
+        for (bool consistent : {false, true}) {
+            uint64_t mixed = 0;
+            measure(consistent ? "ina219 consistent snap" : "ina219 snapshot", seconds, [&]() {
+                INA219::Snapshot snapshot;
+                Status s = ina219s[0]->getSnapshot(snapshot, consistent);
+                mixed += !snapshot.sameConversion;
+                sink = snapshot.supplyPower_mW;
+                return s == SUCCESS;
+            });
+            if (mixed > 0) {
+                cout << std::string(24, ' ') << "   " << mixed << " may mix two conversions\n";
+            }
+        }
+
+        // Blind reads return the same conversion until the next completes; streaming reads each one once
+        INA219& streamed = *ina219s[0];
+        uint64_t blind = 0;
+        Clock::time_point blind_end = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                                          std::chrono::duration<double>(seconds));
+        Clock::time_point blind_start = Clock::now();
+        while (Clock::now() < blind_end) {
+            double value;
+            blind += streamed.getCurrent_mA(value) == SUCCESS;
+        }
+        double conversions = (Clock::now() - blind_start) / std::chrono::duration<double>(streamed.conversionTime());
+        cout << "ina219 blind current: " << blind << " reads of about " << static_cast<uint64_t>(conversions)
+             << " conversions, " << static_cast<int>(std::max(0.0, 100 * (1 - conversions / blind)))
+             << "% duplicates\n";
+
+        for (INA219::Mode mode : {INA219::Continuous, INA219::Triggered}) {
+            const char* name = mode == INA219::Continuous ? "ina219 stream continuous" : "ina219 stream triggered";
+            if (streamed.startStreaming(mode) != SUCCESS) {
+                cout << "INA219 streaming failed\n";
+                return;
+            }
+            measure(name, seconds, [&]() {
+                INA219::Sample sample;
+                Status s = streamed.readNextSample(sample);
+                sink = sample.current;
+                return s == SUCCESS;
+            });
+            INA219::StreamStats stats = streamed.streamStats();
+            cout << std::string(24, ' ') << "   " << static_cast<uint64_t>(stats.samplesPerSecond)
+                 << " samples/s of " << static_cast<uint64_t>(1e6 / streamed.conversionTime().count())
+                 << " possible, " << stats.missed << " missed, " << stats.notReady << " polls not ready\n";
+        }
+        if (streamed.stopStreaming() != SUCCESS) {
+            return;
+        }
+
+        measure("ina260 current", seconds, [&]() {
+            double value;
+            Status s = ina.getCurrent_mA(value);
+            sink = value;
+            return s == SUCCESS;
+        });
+
+        measure("ina260 snapshot", seconds, [&]() {
+            ina260::Ina260::Snapshot snapshot;
+            Status s = ina.getSnapshot(snapshot);
+            sink = snapshot.power_mW;
+            return s == SUCCESS;
+        });
+
+        // Sleeps on the ALERT interrupt; a conversion completes every 2.2 ms with the default configuration
+        if (ina.enableConversionReady(INA260_ALERT_PIN) != SUCCESS) {
+            cout << "INA260 conversion-ready mode failed\n";
+            return;
+        }
+        measure("ina260 on alert", seconds, [&]() {
+            ina260::Ina260::Snapshot snapshot;
+            Status s = ina.waitForSnapshot(snapshot, std::chrono::milliseconds(100));
+            sink = snapshot.power_mW;
+            return s == SUCCESS;
+        });
+        if (ina.disableConversionReady() != SUCCESS) {
+            return;
+        }
+
+        // Four threads, one INA219 each, on the one bus
+        uint64_t ioctls_before = bus->ioctls();
+        uint64_t merged_before = bus->merged();
+        std::atomic<uint64_t> reads{0};
+        Clock::time_point start = Clock::now();
+        std::vector<std::thread> threads;
+        for (std::unique_ptr<INA219>& ina219 : ina219s) {
+            threads.emplace_back([&, monitor = ina219.get()]() {
+                Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(
+                                                    std::chrono::duration<double>(seconds));
+                uint64_t n = 0;
+                while (Clock::now() < end) {
+                    double value;
+                    if (monitor->getCurrent_mA(value) == SUCCESS) {
+                        n++;
+                    }
+                }
+                reads += n;
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        uint64_t ioctls = bus->ioctls() - ioctls_before;
+        uint64_t merged = bus->merged() - merged_before;
+        cout << "4 threads x ina219: " << static_cast<uint64_t>(reads / elapsed) << " reads/s, " << ioctls
+             << " transfers, " << (reads > 0 ? 100 * merged / reads : 0) << "% of reads merged\n";
+
+        // The same four as rails of one group: a fast camera rail and slower housekeeping ones
+        ina219s.clear();
+        std::vector<INA219RailGroup::RailConfig> rails;
+        for (int i = 0; i < 4; i++) {
+            double rate_hz = i == 0 ? 500 : i == 1 ? 100 : 10;
+            rails.push_back({static_cast<INA219::AddrSelect>(i), INA219::GND, 0.1, rate_hz});
+        }
+        ioctls_before = bus->ioctls();
+        INA219RailGroup group(constants::I2C_DEV_1, rails, clock_hz);
+        if (group.init() != SUCCESS) {
+            cout << "INA219 rail group setup failed\n";
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        for (size_t rail = 0; rail < group.rails(); rail++) {
+            INA219RailGroup::RailStats stats = group.stats(rail);
+            cout << "ina219 rail " << rail << " at " << stats.rate_hz << " Hz: " << stats.achieved_hz
+                 << " readings/s, " << 100 * stats.busUtilization << "% of the bus, " << stats.skipped
+                 << " skipped, " << stats.failures << " failed\n";
+        }
+        cout << "ina219 rail group: " << group.sweeps() << " sweeps in " << bus->ioctls() - ioctls_before
+             << " transfers, " << 100 * group.busUtilization() << "% of the bus\n";
+    }
+
+    void run_spi(double seconds, std::chrono::nanoseconds overhead) {
+        cout << "\nSPI at " << UM7_SPI_SPEED / 1000 << " kHz\n";
+
+        SimSpiBackend& spi = SimSpiBackend::platform();
+        spi.set_overhead(overhead);
+        auto imu = std::make_shared<SimUM7>();
+        imu->set_float(UM7::DREG_GYRO_PROC_X, 0.5f);
+        imu->set_noise(0.01f);
+        spi.attach(1, imu);
+
+        UM7 um7(UM7_SPI_SPEED);
+        if (um7.init() != SUCCESS) {
+            cout << "UM7 setup failed\n";
+            return;
+        }
+        measure("um7 register", seconds, [&]() {
+            uint8_t data[4];
+            Status s = um7.read_reg(UM7::DREG_GYRO_PROC_X, data);
+            sink = data[0];
+            return s == SUCCESS;
+        });
+    }
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+    std::chrono::nanoseconds overhead(static_cast<int64_t>((argc > 2 ? std::atof(argv[2]) : 20.0) * 1000));
+
+    for (uint32_t clock_hz : {100000u, 400000u}) {
+        run_i2c(clock_hz, seconds, overhead);
+    }
+    run_spi(seconds, overhead);
+
+    return 0;
+}
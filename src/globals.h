@@ -8,10 +8,15 @@ namespace constants {
 
     // WiringPi pins
     inline constexpr uint8_t UCAM_RESET_PIN = 7;
+    // Level of a GPIO output driven high: the Pi's 3.3 V rail. The PPG102A6 dividers are excited from GPIO pins
+    inline constexpr double GPIO_HIGH_VOLTAGE = 3.3;
 
     // Serial
     inline const char* SERIAL_DEV_0 = "/dev/ttyAMA0";
     inline constexpr uint32_t SERIAL_BAUD_RATE = 921600;
+
+    // I2C
+    inline const char* I2C_DEV_1 = "/dev/i2c-1";
 }
 
 // Error codes
@@ -24,6 +29,15 @@ enum [[nodiscard]] Status {
     I2C_PRIOR_WRITE_FAILURE, // operation relies on the result from a prior write operation, which failed
     I2C_BAD_DATA,
     INVALID_INPUT,
+    CMD_DUPLICATE_ID, // a pending command already uses this id
+    CMD_NOT_FOUND,    // no pending command has this id
+    CMD_QUEUE_EMPTY,
+    POOL_EXHAUSTED,   // no free payload block is large enough
+    CMD_QUEUE_FULL,   // the submission queue or command table has no free slot
+    CMD_TIMEOUT,      // the command overran Command::timeout
+    JOURNAL_FULL,     // the command journal has no room for the record
+    CMD_STALE_ID,     // a pending command has this id's number but a different generation
+    CMD_UNKNOWN,      // no handler is registered for the command's subsystem_id and cmd_num
 };
 
 #endif
@@ -0,0 +1,126 @@
+#include "Checksum.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace {
+#if !defined(__ARM_FEATURE_CRC32)
+    constexpr uint32_t POLYNOMIAL = 0xEDB88320; // 0x04C11DB7 bit-reversed
+
+    using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+    // tables[k][b] is the CRC of byte b followed by k zero bytes, so eight bytes can be folded with eight lookups
+    constexpr Tables make_tables() {
+        Tables tables{};
+        for (uint32_t b = 0; b < 256; b++) {
+            uint32_t crc = b;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (POLYNOMIAL & (0 - (crc & 1)));
+            }
+            tables[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; b++) {
+            for (size_t k = 1; k < 8; k++) {
+                tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xFF];
+            }
+        }
+        return tables;
+    }
+
+    constexpr Tables TABLES = make_tables();
+
+    uint32_t load_le32(const uint8_t* p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+#endif
+
+    // Raw CRC register update, without the initial and final inversion
+    uint32_t update(uint32_t crc, const uint8_t* data, size_t len) {
+#if defined(__ARM_FEATURE_CRC32)
+        for (; len >= 8; data += 8, len -= 8) {
+            uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            crc = __crc32d(crc, word);
+        }
+        for (; len > 0; data++, len--) {
+            crc = __crc32b(crc, *data);
+        }
+#else
+        for (; len >= 8; data += 8, len -= 8) {
+            uint32_t low = load_le32(data) ^ crc;
+            uint32_t high = load_le32(data + 4);
+            crc = TABLES[7][low & 0xFF] ^ TABLES[6][(low >> 8) & 0xFF] ^
+                  TABLES[5][(low >> 16) & 0xFF] ^ TABLES[4][low >> 24] ^
+                  TABLES[3][high & 0xFF] ^ TABLES[2][(high >> 8) & 0xFF] ^
+                  TABLES[1][(high >> 16) & 0xFF] ^ TABLES[0][high >> 24];
+        }
+        for (; len > 0; data++, len--) {
+            crc = (crc >> 8) ^ TABLES[0][(crc ^ *data) & 0xFF];
+        }
+#endif
+        return crc;
+    }
+
+    template <typename T>
+    uint8_t* put_le(uint8_t* out, T value) {
+        for (size_t i = 0; i < sizeof(T); i++) {
+            *out++ = static_cast<uint8_t>(value >> (8 * i));
+        }
+        return out;
+    }
+}
+
+namespace checksum {
+    uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc) {
+        return ~update(~crc, data, len);
+    }
+
+    uint32_t command_checksum(const Command& cmd) {
+        uint8_t header[18];
+        uint8_t* out = put_le(header, cmd.cmd_id);
+        *out++ = cmd.subsystem_id;
+        *out++ = cmd.cmd_num;
+        out = put_le(out, cmd.params_len);
+        out = put_le(out, cmd.exec_time);
+        out = put_le(out, cmd.timeout);
+
+        uint32_t crc = crc32(header, out - header);
+        return cmd.params ? crc32(cmd.params, cmd.params_len, crc) : crc;
+    }
+
+    uint32_t response_checksum(const Response& response) {
+        uint8_t header[8];
+        uint8_t* out = header;
+        *out++ = response.subsystem_id;
+        out = put_le(out, response.cmd_id);
+        *out++ = response.status;
+        out = put_le(out, response.data_len);
+
+        uint32_t crc = crc32(header, out - header);
+        return response.data ? crc32(response.data, response.data_len, crc) : crc;
+    }
+
+    size_t verify_commands(std::span<const Command> commands, std::span<bool> valid) {
+        bool record = valid.size() >= commands.size();
+        size_t failures = 0;
+        for (size_t i = 0; i < commands.size(); i++) {
+            bool ok = command_checksum(commands[i]) == commands[i].checksum;
+            failures += !ok;
+            if (record) {
+                valid[i] = ok;
+            }
+        }
+
+        return failures;
+    }
+
+    void stamp_responses(std::span<Response> responses) {
+        for (Response& response : responses) {
+            response.checksum = response_checksum(response);
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef RAPIDCDH_CHECKSUM_H
+#define RAPIDCDH_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "Command.h"
+
+// CRC-32 (IEEE 802.3, the zlib/PNG polynomial) for Command::checksum and Response::checksum. Uses the ARMv8 CRC32
+// instructions when the compiler targets them, and slice-by-8 tables otherwise. x86 has no instruction for this
+// polynomial (SSE4.2 only does CRC-32C), so hosts use the tables.
+namespace checksum {
+    // Continues a running CRC; pass the previous result as crc to checksum data in pieces
+    uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+
+    // Covers every field except checksum itself, little-endian and in declaration order, followed by the payload
+    uint32_t command_checksum(const Command& cmd);
+    uint32_t response_checksum(const Response& response);
+
+    // Checks every command; valid[i] records the result for commands[i] if valid is at least as long as commands.
+    // Returns the number of commands whose checksum does not match
+    size_t verify_commands(std::span<const Command> commands, std::span<bool> valid = {});
+    // Sets the checksum of every response
+    void stamp_responses(std::span<Response> responses);
+}
+
+
+#endif //RAPIDCDH_CHECKSUM_H
@@ -0,0 +1,146 @@
+#include "Codec.h"
+
+#include <cstring>
+
+namespace {
+    // Byte-wise so that it is correct on any host; compilers fold these into single loads and stores on little-endian
+    template <typename T>
+    T get_le(const uint8_t* in) {
+        T value = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            value |= static_cast<T>(in[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    template <typename T>
+    void put_le(uint8_t* out, T value) {
+        for (size_t i = 0; i < sizeof(T); i++) {
+            out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    // Payloads are never copied on decode, so an empty one is reported as nullptr rather than a pointer past the header
+    uint8_t* payload(uint8_t* start, uint16_t len) {
+        return len > 0 ? start : nullptr;
+    }
+}
+
+namespace codec {
+    size_t encoded_size(const Command& cmd) {
+        return COMMAND_HEADER_SIZE + cmd.params_len;
+    }
+
+    size_t encoded_size(const Response& response) {
+        return RESPONSE_HEADER_SIZE + response.data_len;
+    }
+
+    Status decode_command(std::span<uint8_t> buffer, Command& cmd, size_t& consumed) {
+        if (buffer.size() < COMMAND_HEADER_SIZE) {
+            return INVALID_INPUT;
+        }
+
+        uint8_t* in = buffer.data();
+        uint16_t params_len = get_le<uint16_t>(in + 6);
+        if (buffer.size() - COMMAND_HEADER_SIZE < params_len) {
+            return INVALID_INPUT;
+        }
+
+        cmd.cmd_id = get_le<uint32_t>(in);
+        cmd.subsystem_id = in[4];
+        cmd.cmd_num = in[5];
+        cmd.params_len = params_len;
+        cmd.exec_time = get_le<uint64_t>(in + 8);
+        cmd.timeout = get_le<uint16_t>(in + 16);
+        cmd.checksum = get_le<uint32_t>(in + 18);
+        cmd.params = payload(in + COMMAND_HEADER_SIZE, params_len);
+        consumed = COMMAND_HEADER_SIZE + params_len;
+
+        return SUCCESS;
+    }
+
+    void decode_commands(std::span<uint8_t> buffer, std::span<Command> commands, size_t& count, size_t& consumed) {
+        count = 0;
+        consumed = 0;
+        size_t len;
+        while (count < commands.size() && decode_command(buffer.subspan(consumed), commands[count], len) == SUCCESS) {
+            count++;
+            consumed += len;
+        }
+    }
+
+    Status encode_response(const Response& response, std::span<uint8_t> frame, size_t& written) {
+        size_t size = encoded_size(response);
+        if (frame.size() < size) {
+            return INVALID_INPUT;
+        }
+
+        uint8_t* out = frame.data();
+        out[0] = response.subsystem_id;
+        put_le(out + 1, response.cmd_id);
+        out[5] = response.status;
+        put_le(out + 6, response.data_len);
+        put_le(out + 8, response.checksum);
+        if (response.data_len > 0) {
+            std::memcpy(out + RESPONSE_HEADER_SIZE, response.data, response.data_len);
+        }
+        written = size;
+
+        return SUCCESS;
+    }
+
+    void encode_responses(std::span<const Response> responses, std::span<uint8_t> frame, size_t& count,
+                          size_t& written) {
+        count = 0;
+        written = 0;
+        size_t len;
+        while (count < responses.size() && encode_response(responses[count], frame.subspan(written), len) == SUCCESS) {
+            count++;
+            written += len;
+        }
+    }
+
+    Status encode_command(const Command& cmd, std::span<uint8_t> buffer, size_t& written) {
+        size_t size = encoded_size(cmd);
+        if (buffer.size() < size) {
+            return INVALID_INPUT;
+        }
+
+        uint8_t* out = buffer.data();
+        put_le(out, cmd.cmd_id);
+        out[4] = cmd.subsystem_id;
+        out[5] = cmd.cmd_num;
+        put_le(out + 6, cmd.params_len);
+        put_le(out + 8, cmd.exec_time);
+        put_le(out + 16, cmd.timeout);
+        put_le(out + 18, cmd.checksum);
+        if (cmd.params_len > 0) {
+            std::memcpy(out + COMMAND_HEADER_SIZE, cmd.params, cmd.params_len);
+        }
+        written = size;
+
+        return SUCCESS;
+    }
+
+    Status decode_response(std::span<uint8_t> frame, Response& response, size_t& consumed) {
+        if (frame.size() < RESPONSE_HEADER_SIZE) {
+            return INVALID_INPUT;
+        }
+
+        uint8_t* in = frame.data();
+        uint16_t data_len = get_le<uint16_t>(in + 6);
+        if (frame.size() - RESPONSE_HEADER_SIZE < data_len) {
+            return INVALID_INPUT;
+        }
+
+        response.subsystem_id = in[0];
+        response.cmd_id = get_le<uint32_t>(in + 1);
+        response.status = in[5];
+        response.data_len = data_len;
+        response.checksum = get_le<uint32_t>(in + 8);
+        response.data = payload(in + RESPONSE_HEADER_SIZE, data_len);
+        consumed = RESPONSE_HEADER_SIZE + data_len;
+
+        return SUCCESS;
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef RAPIDCDH_CODEC_H
+#define RAPIDCDH_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "../globals.h"
+#include "Command.h"
+
+// Wire format for uplinked commands and downlinked responses. Every field is little-endian and packed, in declaration
+// order, with the payload straight after the header:
+//
+//   command:  cmd_id u32 | subsystem_id u8 | cmd_num u8 | params_len u16 | exec_time u64 | timeout u16 | checksum u32
+//   response: subsystem_id u8 | cmd_id u32 | status u8 | data_len u16 | checksum u32
+//
+// Decoding never copies a payload: params and data point into the buffer they were decoded from, which must outlive
+// the decoded structs. Checksums are carried as they are; see Checksum.h to verify or compute them.
+namespace codec {
+    inline constexpr size_t COMMAND_HEADER_SIZE = 22;
+    inline constexpr size_t RESPONSE_HEADER_SIZE = 12;
+
+    [[nodiscard]] size_t encoded_size(const Command& cmd);
+    [[nodiscard]] size_t encoded_size(const Response& response);
+
+    // Decodes the packet at the front of buffer and sets consumed to its length. cmd.params points into buffer, or is
+    // nullptr when params_len is 0. INVALID_INPUT if the buffer ends before the packet does
+    [[nodiscard]] Status decode_command(std::span<uint8_t> buffer, Command& cmd, size_t& consumed);
+    // Decodes back-to-back packets into commands until either runs out. count is the number decoded and consumed the
+    // bytes they took up; a partial packet at the end of buffer is left for the caller to complete
+    void decode_commands(std::span<uint8_t> buffer, std::span<Command> commands, size_t& count, size_t& consumed);
+
+    // Writes the response at the front of frame. INVALID_INPUT if it does not fit, in which case nothing is written
+    [[nodiscard]] Status encode_response(const Response& response, std::span<uint8_t> frame, size_t& written);
+    // Writes as many of the responses as fit into frame, in order. count is the number written
+    void encode_responses(std::span<const Response> responses, std::span<uint8_t> frame, size_t& count,
+                          size_t& written);
+
+    // The other direction, for the ground side and for loopback testing
+    [[nodiscard]] Status encode_command(const Command& cmd, std::span<uint8_t> buffer, size_t& written);
+    [[nodiscard]] Status decode_response(std::span<uint8_t> frame, Response& response, size_t& consumed);
+}
+
+
+#endif //RAPIDCDH_CODEC_H
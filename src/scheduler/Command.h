@@ -0,0 +1,50 @@
+#ifndef RAPIDCDH_COMMAND_H
+#define RAPIDCDH_COMMAND_H
+
+#include <cstdint>
+
+// The low 20 bits number a command among those pending, enough for the largest scheduler. The ground bumps the high
+// 12 bits, the generation, each time it reuses a number, so a cancel meant for an earlier use of the number cannot hit
+// the command now using it
+using CommandId = uint32_t;
+
+constexpr uint32_t CMD_NUMBER_BITS = 20;
+constexpr uint32_t CMD_NUMBER_MASK = (1u << CMD_NUMBER_BITS) - 1;
+
+constexpr uint32_t cmd_number(CommandId id) {
+    return id & CMD_NUMBER_MASK;
+}
+
+constexpr uint32_t cmd_generation(CommandId id) {
+    return id >> CMD_NUMBER_BITS;
+}
+
+constexpr CommandId make_cmd_id(uint32_t generation, uint32_t number) {
+    return (generation << CMD_NUMBER_BITS) | (number & CMD_NUMBER_MASK);
+}
+
+// One bit per bus or device that a command needs to itself while it runs
+using ResourceMask = uint32_t;
+
+struct Command {
+    CommandId cmd_id; // Unique among pending commands
+    uint8_t subsystem_id;
+    uint8_t cmd_num;
+    uint16_t params_len;
+    uint8_t *params;
+    uint64_t exec_time; // Time to execute command (ms)
+    uint16_t timeout; // (s)
+    uint32_t checksum;
+};
+
+struct Response {
+    uint8_t subsystem_id;
+    CommandId cmd_id;
+    uint8_t status;
+    uint16_t data_len;
+    uint8_t *data;
+    uint32_t checksum;
+};
+
+
+#endif //RAPIDCDH_COMMAND_H
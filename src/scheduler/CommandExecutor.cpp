@@ -0,0 +1,354 @@
+#include "CommandExecutor.h"
+
+#include <algorithm>
+#include <utility>
+
+void CommandExecutor::IndexRing::assign(uint32_t* storage, uint32_t capacity) {
+    m_storage = storage;
+    m_capacity = capacity;
+    m_head = 0;
+    m_count = 0;
+}
+
+void CommandExecutor::IndexRing::push_back(uint32_t value) {
+    m_storage[(m_head + m_count) % m_capacity] = value;
+    m_count++;
+}
+
+void CommandExecutor::IndexRing::pop_front() {
+    m_head = (m_head + 1) % m_capacity;
+    m_count--;
+}
+
+void CommandExecutor::IndexRing::erase(uint32_t i) {
+    for (; i + 1 < m_count; i++) {
+        m_storage[(m_head + i) % m_capacity] = m_storage[(m_head + i + 1) % m_capacity];
+    }
+    m_count--;
+}
+
+void CommandExecutor::IndexRing::clear() {
+    m_head = 0;
+    m_count = 0;
+}
+
+CommandExecutor::CommandExecutor(Handler handler, size_t workers, ResourceMap resources, size_t capacity,
+                                 size_t lane_capacity)
+    : m_handler(std::move(handler)), m_resources(std::move(resources)),
+      m_jobs(std::clamp<size_t>(capacity, 1, NO_SLOT)),
+      m_deadlines([this](uint64_t ticket) { expire(ticket); }, m_jobs.size()) {
+    workers = std::max<size_t>(workers, 1);
+    capacity = m_jobs.size();
+    lane_capacity = std::clamp<size_t>(lane_capacity, 1, capacity);
+
+    m_free_slots.reserve(capacity);
+    // Lowest slots first, so a lightly loaded executor keeps to the start of m_jobs
+    for (size_t slot = capacity; slot > 0; slot--) {
+        m_free_slots.push_back(static_cast<uint32_t>(slot - 1));
+    }
+    m_completions.reserve(2 * capacity);
+    m_drained.reserve(2 * capacity);
+
+    // A lane is on at most one ready list at a time, so NUM_SUBSYSTEMS entries always suffice
+    m_ring_storage.resize(NUM_SUBSYSTEMS * lane_capacity + workers * NUM_SUBSYSTEMS);
+    uint32_t* storage = m_ring_storage.data();
+    for (size_t i = 0; i < NUM_SUBSYSTEMS; i++) {
+        m_lanes[i].home = i % workers;
+        m_lanes[i].queue.assign(storage, lane_capacity);
+        storage += lane_capacity;
+    }
+    m_ready.resize(workers);
+    for (IndexRing& ready : m_ready) {
+        ready.assign(storage, NUM_SUBSYSTEMS);
+        storage += NUM_SUBSYSTEMS;
+    }
+
+    m_workers.reserve(workers);
+    for (size_t i = 0; i < workers; i++) {
+        m_workers.emplace_back(&CommandExecutor::work, this, i);
+    }
+}
+
+CommandExecutor::~CommandExecutor() {
+    shutdown();
+}
+
+void CommandExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work_available.notify_all();
+    for (std::thread& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    // Nothing runs now, so every command left is queued and still owns its params
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Lane& lane : m_lanes) {
+        for (uint32_t i = 0; i < lane.queue.size(); i++) {
+            Job& job = m_jobs[lane.queue[i]];
+            unwatch(job);
+            m_completions.push_back({job.cmd, status_response(job.cmd, FAILURE), true, true, lane.queue[i]});
+            m_in_flight--;
+        }
+        lane.queue.clear();
+    }
+    for (IndexRing& ready : m_ready) {
+        ready.clear();
+    }
+}
+
+Status CommandExecutor::init() {
+    return m_deadlines.init();
+}
+
+Status CommandExecutor::pin_subsystem(uint8_t subsystem_id, size_t worker) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (worker >= m_workers.size()) {
+        return INVALID_INPUT;
+    }
+
+    move_lane(subsystem_id, worker);
+    return SUCCESS;
+}
+
+void CommandExecutor::unpin_subsystem(uint8_t subsystem_id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    move_lane(subsystem_id, NOT_PINNED);
+}
+
+Status CommandExecutor::submit(const Command& cmd) {
+    ResourceMask resources = m_resources ? m_resources(cmd) : 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) {
+            return FAILURE;
+        }
+
+        Lane& lane = m_lanes[cmd.subsystem_id];
+        if (m_free_slots.empty() || lane.queue.full()) {
+            return CMD_QUEUE_FULL;
+        }
+
+        uint32_t slot = m_free_slots.back();
+        m_free_slots.pop_back();
+        Job& job = m_jobs[slot];
+        job = {cmd, (m_next_ticket++ << 32) | slot, resources, cmd.timeout > 0};
+        lane.queue.push_back(slot);
+        m_in_flight++;
+        if (lane.running_slot == NO_SLOT && lane.queue.size() == 1) {
+            make_ready(cmd.subsystem_id);
+        }
+
+        if (job.watched) {
+            m_deadlines.watch(slot, job.ticket, DeadlineTracker::Clock::now() + std::chrono::seconds(cmd.timeout));
+        }
+    }
+    // The owner may be busy, in which case another worker can steal the lane
+    m_work_available.notify_all();
+
+    return SUCCESS;
+}
+
+size_t CommandExecutor::drain_completions(const CompletionHandler& on_complete, const RetireHandler& on_retire) {
+    m_drained.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(m_completions, m_drained);
+        // Nothing refers to a retired command's slot but the completion copied out here
+        for (const Completion& completion : m_drained) {
+            if (completion.retired) {
+                m_free_slots.push_back(completion.slot);
+            }
+        }
+    }
+
+    size_t completed = 0;
+    for (const Completion& completion : m_drained) {
+        if (completion.completed) {
+            completed++;
+            if (on_complete) {
+                on_complete(completion.cmd, completion.response);
+            }
+        }
+        if (completion.retired && on_retire) {
+            on_retire(completion.cmd);
+        }
+    }
+
+    return completed;
+}
+
+size_t CommandExecutor::workers() const {
+    return m_workers.size();
+}
+
+size_t CommandExecutor::in_flight() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_in_flight;
+}
+
+uint64_t CommandExecutor::overruns(uint8_t subsystem_id) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_overruns[subsystem_id];
+}
+
+Response CommandExecutor::status_response(const Command& cmd, Status status) {
+    return {cmd.subsystem_id, cmd.cmd_id, static_cast<uint8_t>(status), 0, nullptr, 0};
+}
+
+size_t CommandExecutor::owner(const Lane& lane) const {
+    return lane.pinned != NOT_PINNED ? lane.pinned : lane.home;
+}
+
+bool CommandExecutor::runnable(uint8_t subsystem_id) const {
+    return (m_jobs[m_lanes[subsystem_id].queue.front()].resources & m_busy) == 0;
+}
+
+void CommandExecutor::make_ready(uint8_t subsystem_id) {
+    m_ready[owner(m_lanes[subsystem_id])].push_back(subsystem_id);
+}
+
+void CommandExecutor::move_lane(uint8_t subsystem_id, size_t pinned) {
+    Lane& lane = m_lanes[subsystem_id];
+    IndexRing& ready = m_ready[owner(lane)];
+    bool was_ready = false;
+    for (uint32_t i = 0; i < ready.size(); i++) {
+        if (ready[i] == subsystem_id) {
+            ready.erase(i);
+            was_ready = true;
+            break;
+        }
+    }
+
+    lane.pinned = pinned;
+    if (was_ready) {
+        make_ready(subsystem_id);
+        m_work_available.notify_all();
+    }
+}
+
+bool CommandExecutor::take_lane(size_t worker, uint8_t& subsystem_id) {
+    // Lanes waiting on a busy resource stay where they are, in order, until it is released
+    IndexRing& own = m_ready[worker];
+    for (uint32_t i = 0; i < own.size(); i++) {
+        if (runnable(own[i])) {
+            subsystem_id = own[i];
+            own.erase(i);
+            return true;
+        }
+    }
+
+    // Steal from the back of the other workers' lists, leaving pinned lanes where they are
+    for (size_t i = 1; i < m_ready.size(); i++) {
+        IndexRing& other = m_ready[(worker + i) % m_ready.size()];
+        for (uint32_t j = other.size(); j > 0; j--) {
+            if (m_lanes[other[j - 1]].pinned == NOT_PINNED && runnable(other[j - 1])) {
+                subsystem_id = other[j - 1];
+                other.erase(j - 1);
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void CommandExecutor::work(size_t worker) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        uint8_t subsystem_id;
+        while (!m_stopping && !take_lane(worker, subsystem_id)) {
+            m_work_available.wait(lock);
+        }
+        if (m_stopping) {
+            return;
+        }
+
+        Lane& lane = m_lanes[subsystem_id];
+        uint32_t slot = lane.queue.front();
+        lane.queue.pop_front();
+        lane.running_slot = slot;
+        lane.running_overran = false;
+        // The slot stays taken until the job retires, so the reference outlives the unlocked call
+        Job& job = m_jobs[slot];
+        m_busy |= job.resources;
+
+        lock.unlock();
+        Response response = m_handler(job.cmd);
+        response.subsystem_id = job.cmd.subsystem_id;
+        response.cmd_id = job.cmd.cmd_id;
+        lock.lock();
+
+        lane.running_slot = NO_SLOT;
+        if (job.resources != 0) {
+            // Lanes that were waiting on these resources may be able to run now
+            m_busy &= ~job.resources;
+            m_work_available.notify_all();
+        }
+        if (lane.running_overran) {
+            // Already reported as a timeout; only the retirement is left
+            m_completions.push_back({job.cmd, {}, false, true, slot});
+        } else {
+            unwatch(job);
+            m_completions.push_back({job.cmd, response, true, true, slot});
+            m_in_flight--;
+        }
+
+        if (!lane.queue.empty()) {
+            make_ready(subsystem_id);
+            m_work_available.notify_all();
+        }
+    }
+}
+
+void CommandExecutor::expire(uint64_t ticket) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t slot = static_cast<uint32_t>(ticket);
+    Job& job = m_jobs[slot];
+    if (job.ticket != ticket || !job.watched) {
+        return; // Completed while the deadline was being processed
+    }
+    job.watched = false;
+
+    uint8_t subsystem_id = job.cmd.subsystem_id;
+    Lane& lane = m_lanes[subsystem_id];
+    if (lane.running_slot == slot) {
+        lane.running_overran = true;
+        m_completions.push_back({job.cmd, status_response(job.cmd, CMD_TIMEOUT), true, false, slot});
+    } else {
+        uint32_t i = 0;
+        while (i < lane.queue.size() && lane.queue[i] != slot) {
+            i++;
+        }
+        if (i == lane.queue.size()) {
+            return;
+        }
+        m_completions.push_back({job.cmd, status_response(job.cmd, CMD_TIMEOUT), true, true, slot});
+        lane.queue.erase(i);
+        if (lane.queue.empty() && lane.running_slot == NO_SLOT) {
+            IndexRing& ready = m_ready[owner(lane)];
+            uint32_t j = 0;
+            while (ready[j] != subsystem_id) {
+                j++;
+            }
+            ready.erase(j);
+        } else if (lane.running_slot == NO_SLOT) {
+            // The lane may have been waiting on a resource its new front command does not need
+            m_work_available.notify_all();
+        }
+    }
+
+    m_overruns[subsystem_id]++;
+    m_in_flight--;
+}
+
+void CommandExecutor::unwatch(Job& job) {
+    if (job.watched) {
+        job.watched = false;
+        m_deadlines.unwatch(static_cast<uint32_t>(job.ticket));
+    }
+}
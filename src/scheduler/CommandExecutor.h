@@ -0,0 +1,166 @@
+#ifndef RAPIDCDH_COMMANDEXECUTOR_H
+#define RAPIDCDH_COMMANDEXECUTOR_H
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../globals.h"
+#include "Command.h"
+#include "DeadlineTracker.h"
+
+// Runs commands on a pool of worker threads. Each subsystem has its own FIFO lane, and at most one command per
+// subsystem runs at a time, so drivers never see concurrent calls. Every lane has a home worker; a worker with nothing
+// to do at home steals ready lanes from other workers, so a slow command only ever holds up its own subsystem.
+// A lane can be pinned to one worker when its driver must always be called from the same thread.
+//
+// Commands can also claim resources, such as the bus their driver talks over. Commands whose resources overlap never
+// run at the same time, even across subsystems, while commands on separate buses run side by side. A lane whose next
+// command needs a resource that is in use waits without holding up lanes that could run.
+//
+// Command::timeout is enforced from the moment a command is submitted. A command that overruns while still queued is
+// dropped; one that overruns while running cannot be interrupted, so it is reported failed straight away and whatever
+// its handler eventually returns is discarded. Either way it completes with a CMD_TIMEOUT response.
+//
+// Each command holds one of a fixed number of slots from submission until drain_completions retires it. The slots,
+// lane queues and completion lists are all allocated at construction, so submitting and running commands never touch
+// the heap.
+class CommandExecutor {
+public:
+    // Called on a worker thread. subsystem_id and cmd_id of the returned response are filled in by the executor
+    using Handler = std::function<Response(const Command&)>;
+    // Called on the thread that drains completions, once per command
+    using CompletionHandler = std::function<void(const Command&, const Response&)>;
+    // Called on the thread that drains completions once the executor no longer uses the command or its params.
+    // For an overrun that was running this comes after the completion, when its handler finally returns
+    using RetireHandler = std::function<void(const Command&)>;
+    // The resources a command needs, e.g. DispatchTable::resources. Called on the submitting thread
+    using ResourceMap = std::function<ResourceMask(const Command&)>;
+
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    static constexpr size_t DEFAULT_LANE_CAPACITY = 64;
+
+    // capacity is the most commands submitted and not yet retired by drain_completions; lane_capacity the most queued
+    // for one subsystem
+    explicit CommandExecutor(Handler handler, size_t workers = std::thread::hardware_concurrency(),
+                             ResourceMap resources = nullptr, size_t capacity = DEFAULT_CAPACITY,
+                             size_t lane_capacity = DEFAULT_LANE_CAPACITY);
+    // Shuts down as shutdown does
+    ~CommandExecutor();
+
+    CommandExecutor(const CommandExecutor&) = delete;
+    CommandExecutor& operator=(const CommandExecutor&) = delete;
+
+    // FAILURE if the deadline timer could not be set up; commands still run but timeouts are not enforced
+    [[nodiscard]] Status init();
+
+    // Runs the subsystem's commands only on the given worker. INVALID_INPUT if there is no such worker
+    [[nodiscard]] Status pin_subsystem(uint8_t subsystem_id, size_t worker);
+    void unpin_subsystem(uint8_t subsystem_id);
+
+    // Queues a command behind the others for its subsystem. Thread-safe. CMD_QUEUE_FULL if every slot is taken or the
+    // subsystem already has lane_capacity commands queued; FAILURE once shut down
+    [[nodiscard]] Status submit(const Command& cmd);
+
+    // Finishes the commands already running and joins the workers. Queued commands complete with a FAILURE response
+    // and retire, to be reported by the next drain_completions; submit fails from then on
+    void shutdown();
+
+    // Reports every command that completed or retired since the last call. Returns the number of completions
+    size_t drain_completions(const CompletionHandler& on_complete, const RetireHandler& on_retire = nullptr);
+
+    [[nodiscard]] size_t workers() const;
+    // Commands queued or running that have not completed
+    [[nodiscard]] size_t in_flight() const;
+    // Commands of this subsystem that overran their timeout
+    [[nodiscard]] uint64_t overruns(uint8_t subsystem_id) const;
+
+private:
+    static constexpr size_t NUM_SUBSYSTEMS = 256;
+    static constexpr size_t NOT_PINNED = SIZE_MAX;
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    // Fixed-capacity FIFO of indices over storage owned by the executor; erase keeps the order of the rest
+    class IndexRing {
+    public:
+        void assign(uint32_t* storage, uint32_t capacity);
+
+        [[nodiscard]] bool empty() const { return m_count == 0; }
+        [[nodiscard]] bool full() const { return m_count == m_capacity; }
+        [[nodiscard]] uint32_t size() const { return m_count; }
+        [[nodiscard]] uint32_t operator[](uint32_t i) const { return m_storage[(m_head + i) % m_capacity]; }
+        [[nodiscard]] uint32_t front() const { return (*this)[0]; }
+
+        void push_back(uint32_t value);
+        void pop_front();
+        void erase(uint32_t i);
+        void clear();
+
+    private:
+        uint32_t* m_storage = nullptr;
+        uint32_t m_capacity = 0;
+        uint32_t m_head = 0;
+        uint32_t m_count = 0;
+    };
+
+    struct Job {
+        Command cmd;
+        uint64_t ticket; // Slot in the low 32 bits; the rest counts submissions, as the slot is reused
+        ResourceMask resources;
+        bool watched; // Has a deadline that has not passed
+    };
+
+    struct Lane {
+        IndexRing queue; // Slots of the commands waiting, oldest first
+        size_t home;
+        size_t pinned = NOT_PINNED;
+        uint32_t running_slot = NO_SLOT; // Executing, or NO_SLOT
+        bool running_overran = false;
+    };
+
+    struct Completion {
+        Command cmd;
+        Response response;
+        bool completed; // response is valid
+        bool retired; // The slot is freed once drained
+        uint32_t slot;
+    };
+
+    static Response status_response(const Command& cmd, Status status);
+
+    size_t owner(const Lane& lane) const;
+    bool runnable(uint8_t subsystem_id) const;
+    void make_ready(uint8_t subsystem_id);
+    void move_lane(uint8_t subsystem_id, size_t pinned);
+    bool take_lane(size_t worker, uint8_t& subsystem_id);
+    void work(size_t worker);
+    void expire(uint64_t ticket);
+    void unwatch(Job& job);
+
+    Handler m_handler;
+    ResourceMap m_resources;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_work_available;
+    bool m_stopping = false;
+    std::vector<Job> m_jobs; // Indexed by slot
+    std::vector<uint32_t> m_free_slots; // Reserved for every slot
+    std::vector<uint32_t> m_ring_storage; // Backs the lanes' queues and the ready lists
+    std::array<Lane, NUM_SUBSYSTEMS> m_lanes;
+    std::vector<IndexRing> m_ready; // Per worker: lanes with queued commands and nothing running
+    ResourceMask m_busy = 0; // Resources held by running commands
+    std::vector<Completion> m_completions; // Both reserved for a completion and a retirement per slot
+    std::vector<Completion> m_drained;
+    size_t m_in_flight = 0;
+    uint64_t m_next_ticket = 0;
+    std::array<uint64_t, NUM_SUBSYSTEMS> m_overruns{};
+    std::vector<std::thread> m_workers;
+    DeadlineTracker m_deadlines; // Last, so its thread stops before the state it calls into is destroyed
+};
+
+
+#endif //RAPIDCDH_COMMANDEXECUTOR_H
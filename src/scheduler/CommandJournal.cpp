@@ -0,0 +1,283 @@
+#include "CommandJournal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Checksum.h"
+#include "Codec.h"
+
+namespace {
+    // length u32 | type u8 | crc u32 over length, type and payload | payload
+    constexpr size_t HEADER_SIZE = 9;
+
+    uint32_t get_le32(const uint8_t* in) {
+        return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+    }
+
+    void put_le32(uint8_t* out, uint32_t value) {
+        for (size_t i = 0; i < 4; i++) {
+            out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    uint32_t record_crc(const uint8_t* record, uint32_t len) {
+        uint32_t crc = checksum::crc32(record, 5);
+        return checksum::crc32(record + HEADER_SIZE, len, crc);
+    }
+
+    size_t page_floor(size_t offset) {
+        size_t page = sysconf(_SC_PAGESIZE);
+        return offset / page * page;
+    }
+}
+
+CommandJournal::CommandJournal(std::string path, size_t capacity)
+    : m_path(std::move(path)), m_capacity(capacity) {
+    // A leftover temporary file is an interrupted compaction; the journal it was replacing is still complete
+    std::string tmp_path = m_path + ".tmp";
+    unlink(tmp_path.c_str());
+
+    m_fd = open(m_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st{};
+    if (m_fd < 0 || fstat(m_fd, &st) != 0) {
+        m_status = FAILURE;
+        return;
+    }
+    // Never truncate a journal written with a larger capacity
+    m_capacity = std::max(m_capacity, static_cast<size_t>(st.st_size));
+    if (map(m_fd, m_base) != SUCCESS) {
+        m_status = FAILURE;
+        return;
+    }
+
+    size_t records;
+    m_tail = scan(nullptr, records);
+    m_synced = m_tail;
+    scrub();
+}
+
+CommandJournal::~CommandJournal() {
+    if (m_base) {
+        [[maybe_unused]] Status status = sync();
+        munmap(m_base, m_capacity);
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+Status CommandJournal::init() {
+    return m_status;
+}
+
+size_t CommandJournal::replay(const ReplayHandler& handler) const {
+    size_t records = 0;
+    if (m_base) {
+        scan(handler, records);
+    }
+
+    return records;
+}
+
+Status CommandJournal::append(RecordType type, const Command& cmd) {
+    if (!m_base) {
+        return FAILURE;
+    }
+
+    return write_record(m_base, m_capacity, m_tail, type, cmd) ? SUCCESS : JOURNAL_FULL;
+}
+
+Status CommandJournal::compact(std::span<const Command> pending) {
+    if (!m_base) {
+        return FAILURE;
+    }
+
+    size_t size = 0;
+    for (const Command& cmd : pending) {
+        size += record_size(ADD, cmd);
+    }
+    if (size > m_capacity) {
+        return JOURNAL_FULL;
+    }
+
+    std::string tmp_path = m_path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    uint8_t* base = nullptr;
+    if (fd < 0 || map(fd, base) != SUCCESS) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        unlink(tmp_path.c_str());
+        return FAILURE;
+    }
+
+    size_t tail = 0;
+    for (const Command& cmd : pending) {
+        write_record(base, m_capacity, tail, ADD, cmd);
+    }
+
+    // The new file must be complete on storage before the rename makes it the journal
+    if (msync(base, std::max<size_t>(tail, 1), MS_SYNC) != 0 || rename(tmp_path.c_str(), m_path.c_str()) != 0) {
+        munmap(base, m_capacity);
+        close(fd);
+        unlink(tmp_path.c_str());
+        return FAILURE;
+    }
+
+    munmap(m_base, m_capacity);
+    close(m_fd);
+    m_base = base;
+    m_fd = fd;
+    m_tail = tail;
+    m_synced = tail;
+
+    // The swap has happened, so the caller must not treat the pending set as unjournaled. Until the directory
+    // reaches storage a reset can still bring back the old journal; sync() keeps trying
+    m_directory_synced = sync_directory();
+    return SUCCESS;
+}
+
+bool CommandJournal::sync_directory() const {
+    std::filesystem::path dir = std::filesystem::absolute(m_path).parent_path();
+    int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    bool synced = dir_fd >= 0 && fsync(dir_fd) == 0;
+    if (dir_fd >= 0) {
+        close(dir_fd);
+    }
+
+    return synced;
+}
+
+Status CommandJournal::sync() {
+    if (!m_base) {
+        return FAILURE;
+    }
+    if (!m_directory_synced) {
+        m_directory_synced = sync_directory();
+        if (!m_directory_synced) {
+            return FAILURE;
+        }
+    }
+    if (m_synced == m_tail) {
+        return SUCCESS;
+    }
+
+    size_t start = page_floor(m_synced);
+    if (msync(m_base + start, m_tail - start, MS_SYNC) != 0) {
+        return FAILURE;
+    }
+    m_synced = m_tail;
+
+    return SUCCESS;
+}
+
+bool CommandJournal::needs_compaction() const {
+    return m_tail > m_capacity / 2;
+}
+
+size_t CommandJournal::used() const {
+    return m_tail;
+}
+
+size_t CommandJournal::capacity() const {
+    return m_capacity;
+}
+
+size_t CommandJournal::record_size(RecordType type, const Command& cmd) {
+    return HEADER_SIZE + (type == ADD ? codec::encoded_size(cmd) : sizeof(CommandId));
+}
+
+bool CommandJournal::write_record(uint8_t* base, size_t capacity, size_t& tail, RecordType type,
+                                  const Command& cmd) {
+    size_t size = record_size(type, cmd);
+    if (capacity - tail < size) {
+        return false;
+    }
+
+    uint8_t* record = base + tail;
+    uint32_t len = static_cast<uint32_t>(size - HEADER_SIZE);
+    if (type == ADD) {
+        size_t written;
+        [[maybe_unused]] Status status = codec::encode_command(cmd, {record + HEADER_SIZE, len}, written);
+    } else {
+        put_le32(record + HEADER_SIZE, cmd.cmd_id);
+    }
+    put_le32(record, len);
+    record[4] = type;
+    put_le32(record + 5, record_crc(record, len));
+    tail += size;
+
+    return true;
+}
+
+Status CommandJournal::map(int fd, uint8_t*& base) const {
+    // The file is sparse, so only the pages that have been written take up space
+    if (ftruncate(fd, static_cast<off_t>(m_capacity)) != 0) {
+        return FAILURE;
+    }
+
+    void* mapping = mmap(nullptr, m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return FAILURE;
+    }
+    base = static_cast<uint8_t*>(mapping);
+
+    return SUCCESS;
+}
+
+size_t CommandJournal::scan(const ReplayHandler& handler, size_t& records) const {
+    size_t offset = 0;
+    records = 0;
+    while (m_capacity - offset >= HEADER_SIZE) {
+        const uint8_t* record = m_base + offset;
+        uint32_t len = get_le32(record);
+        uint8_t type = record[4];
+        if (type < ADD || type > COMPLETE || len > m_capacity - offset - HEADER_SIZE ||
+            get_le32(record + 5) != record_crc(record, len)) {
+            break;
+        }
+
+        Command cmd{};
+        if (type == ADD) {
+            size_t consumed;
+            // Replay only reads, so the const_cast never results in a write to the mapping
+            std::span<uint8_t> payload(const_cast<uint8_t*>(record) + HEADER_SIZE, len);
+            if (codec::decode_command(payload, cmd, consumed) != SUCCESS || consumed != len) {
+                break;
+            }
+        } else if (len == sizeof(CommandId)) {
+            cmd.cmd_id = get_le32(record + HEADER_SIZE);
+        } else {
+            break;
+        }
+
+        if (handler) {
+            handler(static_cast<RecordType>(type), cmd);
+        }
+        offset += HEADER_SIZE + len;
+        records++;
+    }
+
+    return offset;
+}
+
+void CommandJournal::scrub() {
+    // Pages can reach storage out of order, so a torn tail may be followed by intact records from before the reset.
+    // Clear everything after the tail so that later appends can never line up with one of them
+    size_t end = m_capacity;
+    while (end > m_tail && m_base[end - 1] == 0) {
+        end--;
+    }
+    if (end > m_tail) {
+        std::memset(m_base + m_tail, 0, end - m_tail);
+        size_t start = page_floor(m_tail);
+        msync(m_base + start, end - start, MS_SYNC);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef RAPIDCDH_COMMANDJOURNAL_H
+#define RAPIDCDH_COMMANDJOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+
+#include "../globals.h"
+#include "Command.h"
+
+// Append-only log of changes to the pending command set, kept in a memory-mapped file so that the pending set survives
+// a watchdog reset. Each record carries a CRC, and replay stops at the first record that is missing or damaged, so a
+// record torn by power loss is simply not there. Nothing reaches storage until sync().
+//
+// The log only grows; compact() replaces it with one ADD record per pending command by writing a new file and renaming
+// it over the old one, so a reset during compaction leaves one complete journal or the other.
+class CommandJournal {
+public:
+    enum RecordType : uint8_t {
+        ADD = 1,
+        REMOVE,   // Cancelled by remove_command
+        COMPLETE, // Dispatched
+    };
+
+    // cmd.params points into the mapping and is only valid during the call. REMOVE and COMPLETE only carry cmd_id
+    using ReplayHandler = std::function<void(RecordType type, const Command& cmd)>;
+
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 20; // Bytes
+
+    explicit CommandJournal(std::string path, size_t capacity = DEFAULT_CAPACITY);
+    ~CommandJournal();
+
+    CommandJournal(const CommandJournal&) = delete;
+    CommandJournal& operator=(const CommandJournal&) = delete;
+
+    // FAILURE if the file could not be opened or mapped; the journal then records nothing
+    [[nodiscard]] Status init();
+
+    // Calls handler for every intact record, oldest first. Returns the number of records
+    size_t replay(const ReplayHandler& handler) const;
+
+    // JOURNAL_FULL if the record does not fit in the space left; compact() to make room
+    [[nodiscard]] Status append(RecordType type, const Command& cmd);
+    // Atomically replaces the journal with an ADD record for each command, in order. JOURNAL_FULL if they do not all
+    // fit, in which case the journal is left as it was. Once the new file is in place this succeeds even if its
+    // directory entry could not be written through yet; sync() retries that and fails until it is
+    [[nodiscard]] Status compact(std::span<const Command> pending);
+    // Writes every record appended so far, and the directory entry of the last compaction, through to storage
+    [[nodiscard]] Status sync();
+
+    // More than half the capacity is taken up, so the log is worth compacting
+    [[nodiscard]] bool needs_compaction() const;
+    [[nodiscard]] size_t used() const;
+    [[nodiscard]] size_t capacity() const;
+
+private:
+    static size_t record_size(RecordType type, const Command& cmd);
+    static bool write_record(uint8_t* base, size_t capacity, size_t& tail, RecordType type, const Command& cmd);
+    Status map(int fd, uint8_t*& base) const;
+    size_t scan(const ReplayHandler& handler, size_t& records) const;
+    void scrub();
+    bool sync_directory() const;
+
+    std::string m_path;
+    size_t m_capacity;
+    Status m_status = SUCCESS;
+    int m_fd = -1;
+    uint8_t* m_base = nullptr;
+    size_t m_tail = 0;   // End of the last intact record
+    size_t m_synced = 0; // Records before this offset have reached storage
+    bool m_directory_synced = true; // False while a reset could still bring back the journal compact() replaced
+};
+
+
+#endif //RAPIDCDH_COMMANDJOURNAL_H
@@ -1 +1,381 @@
 #include "CommandScheduler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+CommandScheduler::CommandScheduler(Dispatcher dispatcher, Backend backend,
+                                   std::vector<PayloadPool::SizeClass> payload_classes, size_t capacity)
+    : m_dispatcher(std::move(dispatcher)), m_backend(backend), m_payloads(std::move(payload_classes)),
+      m_entries(std::min<size_t>(capacity, CMD_NUMBER_MASK + 1)), m_table(m_entries.size()) {
+    m_heap.reserve(m_entries.size());
+    m_free_entries.reserve(m_entries.size());
+    for (size_t i = m_entries.size(); i > 0; i--) {
+        m_free_entries.push_back(static_cast<uint32_t>(i - 1));
+    }
+}
+
+Status CommandScheduler::add_command(Command cmd) {
+    if (m_validator) {
+        Status status = m_validator(cmd);
+        if (status != SUCCESS) {
+            return status;
+        }
+    }
+    if (m_free_entries.empty()) {
+        return CMD_QUEUE_FULL;
+    }
+    uint32_t index = m_free_entries.back();
+    Status status = m_table.insert(cmd.cmd_id, index);
+    if (status != SUCCESS) {
+        return status;
+    }
+    m_free_entries.pop_back();
+
+    uint64_t seq = m_next_seq++;
+    Entry& entry = m_entries[index];
+    entry = {cmd, seq, m_heap.size(), 0};
+    if (m_backend == TIMING_WHEEL) {
+        entry.wheel_handle = m_wheel.insert(cmd.exec_time, seq, index);
+    } else {
+        m_heap.push_back({cmd.exec_time, seq, &entry});
+        sift_up(m_heap.size() - 1);
+    }
+
+    status = record(CommandJournal::ADD, cmd);
+    if (status != SUCCESS) {
+        // A command that would not survive a reset is not accepted; the caller keeps its payload
+        unschedule(entry);
+        free_entry(entry);
+        return status;
+    }
+
+    return SUCCESS;
+}
+
+Status CommandScheduler::remove_command(CommandId cmd_id) {
+    uint32_t index;
+    Status status = m_table.find(cmd_id, index);
+    if (status != SUCCESS) {
+        return status;
+    }
+
+    Entry& entry = m_entries[index];
+    Command cmd = entry.cmd;
+    unschedule(entry);
+    m_payloads.release(cmd.params);
+    free_entry(entry);
+
+    // The command is gone either way; a failure means it may come back after a reset
+    return record(CommandJournal::REMOVE, cmd);
+}
+
+Status CommandScheduler::submit_command(const Command& cmd) {
+    return m_submissions.try_push(cmd) ? SUCCESS : CMD_QUEUE_FULL;
+}
+
+size_t CommandScheduler::drain_submissions() {
+    // Bounded so that producers submitting faster than this loop runs cannot keep it here forever
+    size_t added = 0;
+    Command cmd;
+    for (size_t i = 0; i < SUBMISSION_CAPACITY && m_submissions.try_pop(cmd); i++) {
+        if (add_command(cmd) == SUCCESS) {
+            added++;
+        } else {
+            // Nobody else holds the command any more, so its payload goes back too
+            m_payloads.release(cmd.params);
+            m_rejected_submissions++;
+        }
+    }
+
+    return added;
+}
+
+uint64_t CommandScheduler::rejected_submissions() const {
+    return m_rejected_submissions;
+}
+
+CommandScheduler::~CommandScheduler() {
+    set_executor(nullptr);
+}
+
+void CommandScheduler::set_executor(CommandExecutor* executor, CommandExecutor::CompletionHandler on_complete) {
+    if (m_executor && m_executor != executor) {
+        // Report and release everything the old executor still holds, so that no payload is left behind with it
+        m_executor->shutdown();
+        m_executor->drain_completions(m_on_complete, [this](const Command& cmd) {
+            m_payloads.release(cmd.params);
+        });
+    }
+    m_executor = executor;
+    m_on_complete = std::move(on_complete);
+}
+
+void CommandScheduler::set_validator(Validator validator) {
+    m_validator = std::move(validator);
+}
+
+Status CommandScheduler::attach_journal(CommandJournal* journal) {
+    m_journal = nullptr;
+    if (!journal) {
+        return SUCCESS;
+    }
+
+    // Replay with journaling off, since every record is already in the journal. Keep going past failures so that as
+    // much as possible is restored, and report the first
+    Status status = SUCCESS;
+    auto note = [&status](Status result) {
+        if (status == SUCCESS) {
+            status = result;
+        }
+    };
+    journal->replay([this, &note](CommandJournal::RecordType type, const Command& cmd) {
+        if (type != CommandJournal::ADD) {
+            uint32_t index;
+            if (m_table.find(cmd.cmd_id, index) == SUCCESS) {
+                note(remove_command(cmd.cmd_id));
+            }
+            return;
+        }
+
+        // The journal's mapping is replaced on compaction, so params need a home of their own
+        Command restored = cmd;
+        if (cmd.params_len > 0) {
+            Status allocated = m_payloads.allocate(cmd.params_len, restored.params);
+            if (allocated != SUCCESS) {
+                note(allocated);
+                return;
+            }
+            std::memcpy(restored.params, cmd.params, cmd.params_len);
+        }
+        Status added = add_command(restored);
+        if (added != SUCCESS) {
+            m_payloads.release(restored.params);
+            note(added);
+        }
+    });
+
+    // Start from a clean snapshot, which also drops any damaged tail that replay stopped at. If even that fails the
+    // journal is left detached, rather than turning away every command that follows
+    m_journal = journal;
+    Status compacted = compact_journal();
+    if (compacted != SUCCESS) {
+        m_journal = nullptr;
+        note(compacted);
+    }
+
+    return status;
+}
+
+uint64_t CommandScheduler::journal_failures() const {
+    return m_journal_failures;
+}
+
+size_t CommandScheduler::run_until(uint64_t now) {
+    drain_submissions();
+    if (m_executor) {
+        m_executor->drain_completions(m_on_complete, [this](const Command& cmd) {
+            m_payloads.release(cmd.params);
+        });
+    }
+
+    size_t dispatched = 0;
+    if (m_backend == TIMING_WHEEL) {
+        dispatched = run_wheel_until(now);
+    } else {
+        while (!m_heap.empty() && m_heap.front().exec_time <= now) {
+            // Take the command out before dispatching so that the dispatcher is free to modify the schedule
+            Entry& entry = *m_heap.front().entry;
+            Command cmd = entry.cmd;
+            erase_at(0);
+            free_entry(entry);
+
+            dispatch(cmd);
+            dispatched++;
+        }
+    }
+
+    if (m_journal) {
+        if (m_journal->needs_compaction() && compact_journal() != SUCCESS) {
+            m_journal_failures++;
+        }
+        if (m_journal->sync() != SUCCESS) {
+            m_journal_failures++;
+        }
+    }
+
+    return dispatched;
+}
+
+Status CommandScheduler::next_deadline(uint64_t& exec_time) const {
+    if (m_backend == TIMING_WHEEL) {
+        return m_wheel.earliest(exec_time) ? SUCCESS : CMD_QUEUE_EMPTY;
+    }
+    if (m_heap.empty()) {
+        return CMD_QUEUE_EMPTY;
+    }
+
+    exec_time = m_heap.front().exec_time;
+    return SUCCESS;
+}
+
+size_t CommandScheduler::pending() const {
+    return m_table.size();
+}
+
+size_t CommandScheduler::capacity() const {
+    return m_entries.size();
+}
+
+Status CommandScheduler::allocate_payload(uint32_t len, uint8_t*& data) {
+    return m_payloads.allocate(len, data);
+}
+
+void CommandScheduler::release_payload(const uint8_t* data) {
+    m_payloads.release(data);
+}
+
+PayloadPool::Stats CommandScheduler::payload_stats() const {
+    return m_payloads.stats();
+}
+
+size_t CommandScheduler::run_wheel_until(uint64_t now) {
+    size_t dispatched = 0;
+    while (m_wheel.advance(now, m_wheel_due)) {
+        // Take the whole tick out before dispatching so that the dispatcher is free to modify the schedule
+        m_wheel_batch.clear();
+        for (const TimingWheel::Expired& expired : m_wheel_due) {
+            Entry& entry = m_entries[expired.key];
+            m_wheel_batch.push_back(entry.cmd);
+            free_entry(entry);
+        }
+
+        for (const Command& cmd : m_wheel_batch) {
+            dispatch(cmd);
+            dispatched++;
+        }
+    }
+
+    return dispatched;
+}
+
+bool CommandScheduler::earlier(const HeapNode& a, const HeapNode& b) {
+    return a.exec_time < b.exec_time || (a.exec_time == b.exec_time && a.seq < b.seq);
+}
+
+void CommandScheduler::place(size_t pos, const HeapNode& node) {
+    m_heap[pos] = node;
+    node.entry->heap_pos = pos;
+}
+
+void CommandScheduler::sift_up(size_t pos) {
+    HeapNode node = m_heap[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!earlier(node, m_heap[parent])) {
+            break;
+        }
+        place(pos, m_heap[parent]);
+        pos = parent;
+    }
+    place(pos, node);
+}
+
+void CommandScheduler::sift_down(size_t pos) {
+    HeapNode node = m_heap[pos];
+    size_t size = m_heap.size();
+    while (true) {
+        size_t child = 2 * pos + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && earlier(m_heap[child + 1], m_heap[child])) {
+            child++;
+        }
+        if (!earlier(m_heap[child], node)) {
+            break;
+        }
+        place(pos, m_heap[child]);
+        pos = child;
+    }
+    place(pos, node);
+}
+
+void CommandScheduler::erase_at(size_t pos) {
+    size_t last = m_heap.size() - 1;
+    if (pos != last) {
+        place(pos, m_heap[last]);
+        m_heap.pop_back();
+        // The moved node may belong either above or below its new position
+        sift_up(pos);
+        sift_down(m_heap[pos].entry->heap_pos);
+    } else {
+        m_heap.pop_back();
+    }
+}
+
+void CommandScheduler::unschedule(const Entry& entry) {
+    if (m_backend == TIMING_WHEEL) {
+        m_wheel.cancel(entry.wheel_handle);
+    } else {
+        erase_at(entry.heap_pos);
+    }
+}
+
+void CommandScheduler::free_entry(const Entry& entry) {
+    // Only ever called for an entry that is in the table, so this cannot fail
+    [[maybe_unused]] Status status = m_table.erase(entry.cmd.cmd_id);
+    m_free_entries.push_back(static_cast<uint32_t>(&entry - m_entries.data()));
+}
+
+Status CommandScheduler::record(CommandJournal::RecordType type, const Command& cmd) {
+    if (!m_journal) {
+        return SUCCESS;
+    }
+    if (m_journal->append(type, cmd) == SUCCESS) {
+        return SUCCESS;
+    }
+
+    // Out of room: a snapshot of the pending set, which already reflects this change, replaces the whole log
+    return compact_journal();
+}
+
+Status CommandScheduler::compact_journal() {
+    m_journal_snapshot.clear();
+    m_table.for_each([this](CommandId, uint32_t index) {
+        m_journal_snapshot.push_back(&m_entries[index]);
+    });
+    // In the order they were added, so that commands with equal exec_time still dispatch in that order after replay
+    std::sort(m_journal_snapshot.begin(), m_journal_snapshot.end(), [](const Entry* a, const Entry* b) {
+        return a->seq < b->seq;
+    });
+
+    m_journal_commands.clear();
+    for (const Entry* entry : m_journal_snapshot) {
+        m_journal_commands.push_back(entry->cmd);
+    }
+
+    return m_journal->compact(m_journal_commands);
+}
+
+void CommandScheduler::dispatch(const Command& cmd) {
+    // Journaled before it runs: a command in flight at a reset is not run a second time
+    if (record(CommandJournal::COMPLETE, cmd) != SUCCESS) {
+        m_journal_failures++;
+    }
+
+    if (m_executor) {
+        Status status = m_executor->submit(cmd);
+        if (status == SUCCESS) {
+            // The payload stays live until the executor reports the command complete
+            return;
+        }
+        // A full or shut down executor turns commands away; report it as a command that failed with that status
+        if (m_on_complete) {
+            m_on_complete(cmd, {cmd.subsystem_id, cmd.cmd_id, static_cast<uint8_t>(status), 0, nullptr, 0});
+        }
+    } else if (m_dispatcher) {
+        m_dispatcher(cmd);
+    }
+    m_payloads.release(cmd.params);
+}
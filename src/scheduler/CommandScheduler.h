@@ -1,42 +1,149 @@
 #ifndef RAPIDCDH_COMMANDSCHEDULER_H
 #define RAPIDCDH_COMMANDSCHEDULER_H
 
+#include <cstddef>
 #include <cstdint>
-#include <queue>
-#include <unordered_map>
+#include <functional>
+#include <vector>
 
 #include "../globals.h"
-
-struct Command {
-    uint8_t cmd_id; // Unique id
-    uint8_t subsystem_id;
-    uint8_t cmd_num;
-    uint16_t params_len;
-    uint8_t *params;
-    uint64_t exec_time; // Time to execute command (ms)
-    uint16_t timeout; // (s)
-    uint32_t checksum;
-};
-
-struct Response {
-    uint8_t subsystem_id;
-    uint8_t cmd_id;
-    uint8_t status;
-    uint16_t data_len;
-    uint8_t *data;
-    uint32_t checksum;
-};
+#include "Command.h"
+#include "CommandExecutor.h"
+#include "CommandJournal.h"
+#include "CommandTable.h"
+#include "MpscQueue.h"
+#include "PayloadPool.h"
+#include "TimingWheel.h"
 
 class CommandScheduler {
 public:
-    CommandScheduler();
+    // Called once for each command when it becomes due
+    using Dispatcher = std::function<void(const Command&)>;
+    // Decides whether a command may be queued at all, e.g. DispatchTable::check. Anything but SUCCESS rejects it
+    using Validator = std::function<Status(const Command&)>;
+
+    // How pending commands are ordered by exec_time
+    enum Backend {
+        HEAP,        // Binary min-heap: O(log n) add, cancel and dispatch
+        TIMING_WHEEL // Hierarchical timing wheel: O(1) add, cancel and dispatch; suited to long timelines
+    };
+
+    // capacity is the most commands that can be pending at once; their entries are allocated up front. It is capped
+    // at the number of distinct command numbers, CMD_NUMBER_MASK + 1
+    explicit CommandScheduler(Dispatcher dispatcher = nullptr, Backend backend = HEAP,
+                              std::vector<PayloadPool::SizeClass> payload_classes = PayloadPool::default_classes(),
+                              size_t capacity = DEFAULT_CAPACITY);
+    // Detaches the executor, if any
+    ~CommandScheduler();
+
+    // Queues a command to be dispatched at cmd.exec_time. O(log n) with HEAP, O(1) with TIMING_WHEEL
+    // If cmd.params came from allocate_payload, the scheduler owns it once the command is queued and releases it after
+    // the command is dispatched or removed. The dispatcher must copy anything it needs to keep. Params that point
+    // inside a pooled block, e.g. decoded in place from a receive buffer, stay with whoever holds that buffer
+    // Returns the validator's status if it rejects the command; CMD_DUPLICATE_ID if any generation of the id's number
+    // is pending; CMD_QUEUE_FULL once capacity() are
+    [[nodiscard]] Status add_command(Command cmd);
+    // Cancels a pending command. O(log n) with HEAP, O(1) with TIMING_WHEEL. CMD_STALE_ID if the pending command with
+    // this id's number is a different generation, which is then left alone
+    [[nodiscard]] Status remove_command(CommandId cmd_id);
+
+    // Hands a command to the dispatch thread from any thread without locking. It is queued by the next
+    // drain_submissions (or run_until); if that add fails the command is dropped and counted in rejected_submissions.
+    // Fails with CMD_QUEUE_FULL when SUBMISSION_CAPACITY commands are already waiting
+    [[nodiscard]] Status submit_command(const Command& cmd);
+    // Queues every command submitted so far. Returns the number added
+    size_t drain_submissions();
+    [[nodiscard]] uint64_t rejected_submissions() const;
+
+    // Sends due commands to an executor instead of the dispatcher. on_complete is called with each response, including
+    // CMD_TIMEOUT responses for overruns and the submit status for commands the executor would not take, on the thread
+    // that calls run_until. Payloads are released once the executor retires the command.
+    // Replacing or detaching (nullptr) an executor shuts it down: its queued commands complete with FAILURE through
+    // the old on_complete and their payloads are released. The executor must outlive the scheduler, which detaches it
+    void set_executor(CommandExecutor* executor, CommandExecutor::CompletionHandler on_complete = nullptr);
 
-    Status add_command(Command cmd);
-    Status remove_command(uint8_t cmd_id);
+    // Checks every command before it is queued, including submitted and journaled ones. nullptr accepts everything
+    void set_validator(Validator validator);
+
+    // Drains submissions and executor completions, then dispatches every pending command with exec_time <= now (ms) in exec_time order. Commands with equal exec_time
+    // are dispatched in the order they were added. The dispatcher may add or remove commands.
+    // With TIMING_WHEEL, all commands due in the same millisecond are taken out together before any is dispatched.
+    // Returns the number of commands dispatched
+    size_t run_until(uint64_t now);
+
+    // Records every change to the pending set in journal so that it survives a reset. Pending commands held in the
+    // journal are restored first, their params copied into the payload pool, and the journal is then compacted to
+    // the merged pending set. Commands are journaled complete as they are dispatched, so one that was running at a
+    // reset is not run again. run_until syncs the journal before returning and compacts it once it is half full.
+    // With a journal attached, add_command fails rather than accept a command it cannot journal.
+    // The journal must have been initialised and must outlive the scheduler or be detached by passing nullptr
+    [[nodiscard]] Status attach_journal(CommandJournal* journal);
+    // Records that could not be written, and syncs that failed, so that changes may be missing after a reset
+    [[nodiscard]] uint64_t journal_failures() const;
+
+    // Earliest exec_time of any pending command; CMD_QUEUE_EMPTY if nothing is pending
+    [[nodiscard]] Status next_deadline(uint64_t& exec_time) const;
+
+    [[nodiscard]] size_t pending() const;
+    [[nodiscard]] size_t capacity() const;
+
+    // Payload memory for Command::params and Response::data, drawn from a fixed pool allocated at construction.
+    // Response data is not tracked by the scheduler; whoever consumes the response hands it back with release_payload.
+    // Any thread may allocate or release, so producers can fill params before submit_command
+    [[nodiscard]] Status allocate_payload(uint32_t len, uint8_t*& data);
+    void release_payload(const uint8_t* data);
+    // Blocks in use and high-water marks per size class, for sizing the pool
+    [[nodiscard]] PayloadPool::Stats payload_stats() const;
+
+    static constexpr size_t SUBMISSION_CAPACITY = 1024;
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
 
 private:
-    std::queue<Command> cmd_queue;
-    std::unordered_map<uint8_t, Command> cmd_map;
+    struct Entry {
+        Command cmd;
+        uint64_t seq;
+        size_t heap_pos;
+        TimingWheel::Handle wheel_handle;
+    };
+
+    struct HeapNode {
+        uint64_t exec_time;
+        uint64_t seq; // Insertion order, breaks ties between equal exec_times
+        Entry* entry; // m_entries never reallocates, so this stays valid
+    };
+
+    static bool earlier(const HeapNode& a, const HeapNode& b);
+    void place(size_t pos, const HeapNode& node);
+    void sift_up(size_t pos);
+    void sift_down(size_t pos);
+    void erase_at(size_t pos);
+    size_t run_wheel_until(uint64_t now);
+    void unschedule(const Entry& entry);
+    void free_entry(const Entry& entry);
+    Status record(CommandJournal::RecordType type, const Command& cmd);
+    Status compact_journal();
+    void dispatch(const Command& cmd);
+
+    Dispatcher m_dispatcher;
+    CommandExecutor* m_executor = nullptr;
+    CommandExecutor::CompletionHandler m_on_complete;
+    Validator m_validator;
+    Backend m_backend;
+    uint64_t m_next_seq = 0;
+    std::vector<HeapNode> m_heap; // Binary min-heap ordered by (exec_time, seq)
+    TimingWheel m_wheel;
+    PayloadPool m_payloads;
+    MpscQueue<Command> m_submissions{SUBMISSION_CAPACITY};
+    uint64_t m_rejected_submissions = 0;
+    std::vector<TimingWheel::Expired> m_wheel_due;
+    std::vector<Command> m_wheel_batch;
+    CommandJournal* m_journal = nullptr;
+    uint64_t m_journal_failures = 0;
+    std::vector<const Entry*> m_journal_snapshot;
+    std::vector<Command> m_journal_commands;
+    std::vector<Entry> m_entries; // capacity entries, allocated up front
+    std::vector<uint32_t> m_free_entries; // Stack of free indices into m_entries
+    CommandTable m_table; // cmd_id to index into m_entries
 };
 
 
@@ -0,0 +1,86 @@
+#include "CommandTable.h"
+
+#include <algorithm>
+#include <bit>
+
+CommandTable::CommandTable(size_t capacity) : m_capacity(capacity) {
+    size_t slots = std::bit_ceil(std::max<size_t>(2 * capacity, 2));
+    m_slots = std::make_unique<Slot[]>(slots);
+    for (size_t i = 0; i < slots; i++) {
+        m_slots[i] = {0, EMPTY};
+    }
+    m_mask = slots - 1;
+    m_shift = 32 - std::countr_zero(slots);
+}
+
+Status CommandTable::insert(CommandId id, uint32_t value) {
+    size_t i = probe(id);
+    if (m_slots[i].value != EMPTY) {
+        return CMD_DUPLICATE_ID;
+    }
+    if (m_size == m_capacity) {
+        return CMD_QUEUE_FULL;
+    }
+
+    m_slots[i] = {id, value};
+    m_size++;
+    return SUCCESS;
+}
+
+Status CommandTable::find(CommandId id, uint32_t& value) const {
+    const Slot& slot = m_slots[probe(id)];
+    if (slot.value == EMPTY) {
+        return CMD_NOT_FOUND;
+    }
+    if (slot.id != id) {
+        return CMD_STALE_ID;
+    }
+
+    value = slot.value;
+    return SUCCESS;
+}
+
+Status CommandTable::erase(CommandId id) {
+    size_t hole = probe(id);
+    if (m_slots[hole].value == EMPTY) {
+        return CMD_NOT_FOUND;
+    }
+    if (m_slots[hole].id != id) {
+        return CMD_STALE_ID;
+    }
+
+    // Shift later members of the cluster back into the hole, unless that would move one before its home slot
+    for (size_t i = (hole + 1) & m_mask; m_slots[i].value != EMPTY; i = (i + 1) & m_mask) {
+        size_t distance_to_home = (i - home(m_slots[i].id)) & m_mask;
+        size_t distance_to_hole = (i - hole) & m_mask;
+        if (distance_to_home >= distance_to_hole) {
+            m_slots[hole] = m_slots[i];
+            hole = i;
+        }
+    }
+    m_slots[hole].value = EMPTY;
+    m_size--;
+
+    return SUCCESS;
+}
+
+size_t CommandTable::size() const {
+    return m_size;
+}
+
+size_t CommandTable::capacity() const {
+    return m_capacity;
+}
+
+size_t CommandTable::home(CommandId id) const {
+    return (cmd_number(id) * 0x9E3779B9u) >> m_shift;
+}
+
+size_t CommandTable::probe(CommandId id) const {
+    // The table is never more than half full, so this always reaches a free slot
+    size_t i = home(id);
+    while (m_slots[i].value != EMPTY && cmd_number(m_slots[i].id) != cmd_number(id)) {
+        i = (i + 1) & m_mask;
+    }
+    return i;
+}
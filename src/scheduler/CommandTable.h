@@ -0,0 +1,59 @@
+#ifndef RAPIDCDH_COMMANDTABLE_H
+#define RAPIDCDH_COMMANDTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "../globals.h"
+#include "Command.h"
+
+// Open-addressing hash table from a pending command's id to a caller-chosen index, in one flat array allocated up
+// front. Ids are keyed by their number alone, so at most one generation of each number is present: looking up an
+// older or newer generation of a number that is present reports CMD_STALE_ID instead of CMD_NOT_FOUND.
+// Linear probing with backward-shift deletion, so there are no tombstones and lookups never degrade over time.
+class CommandTable {
+public:
+    // Holds up to capacity ids; the array is at least twice that so probe sequences stay short
+    explicit CommandTable(size_t capacity);
+
+    // CMD_DUPLICATE_ID if any generation of the id's number is present; CMD_QUEUE_FULL if the table holds capacity ids
+    [[nodiscard]] Status insert(CommandId id, uint32_t value);
+    // CMD_NOT_FOUND if the number is absent; CMD_STALE_ID if a different generation of it is present
+    [[nodiscard]] Status find(CommandId id, uint32_t& value) const;
+    [[nodiscard]] Status erase(CommandId id);
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t capacity() const;
+
+    // Calls f(id, value) for every id present, in no particular order
+    template <typename F>
+    void for_each(F f) const {
+        for (size_t i = 0; i <= m_mask; i++) {
+            if (m_slots[i].value != EMPTY) {
+                f(m_slots[i].id, m_slots[i].value);
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    struct Slot {
+        CommandId id;
+        uint32_t value; // EMPTY if the slot is free
+    };
+
+    size_t home(CommandId id) const;
+    // Index of the slot holding id's number, or of the free slot where it would go
+    size_t probe(CommandId id) const;
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+    uint32_t m_shift; // Fibonacci hashing keeps the top bits of the product
+    size_t m_capacity;
+    size_t m_size = 0;
+};
+
+
+#endif //RAPIDCDH_COMMANDTABLE_H
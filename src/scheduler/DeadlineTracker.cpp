@@ -0,0 +1,186 @@
+#include "DeadlineTracker.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+DeadlineTracker::DeadlineTracker(ExpiryHandler on_expired, size_t capacity)
+    : m_on_expired(std::move(on_expired)), m_heap_pos(capacity, NOT_WATCHED) {
+    m_heap.reserve(capacity);
+
+    m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_timer_fd < 0 || m_wake_fd < 0 || m_epoll_fd < 0) {
+        m_status = FAILURE;
+        return;
+    }
+
+    epoll_event timer_event{};
+    timer_event.events = EPOLLIN;
+    timer_event.data.fd = m_timer_fd;
+    epoll_event wake_event{};
+    wake_event.events = EPOLLIN;
+    wake_event.data.fd = m_wake_fd;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_timer_fd, &timer_event) < 0 ||
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wake_fd, &wake_event) < 0) {
+        m_status = FAILURE;
+        return;
+    }
+
+    m_thread = std::thread(&DeadlineTracker::run, this);
+}
+
+DeadlineTracker::~DeadlineTracker() {
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t res = write(m_wake_fd, &one, sizeof(one));
+        m_thread.join();
+    }
+
+    for (int fd : {m_timer_fd, m_wake_fd, m_epoll_fd}) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+Status DeadlineTracker::init() {
+    return m_status;
+}
+
+void DeadlineTracker::watch(uint32_t slot, uint64_t ticket, Clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_heap_pos[slot] != NOT_WATCHED) {
+        erase_at(m_heap_pos[slot]);
+    }
+    m_heap.push_back({deadline, ticket, slot});
+    sift_up(m_heap.size() - 1);
+    if (deadline < m_armed) {
+        arm();
+    }
+}
+
+bool DeadlineTracker::unwatch(uint32_t slot) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_heap_pos[slot] == NOT_WATCHED) {
+        return false;
+    }
+
+    // Leave the timer armed if this was the earliest; a spurious wake-up just finds nothing expired
+    erase_at(m_heap_pos[slot]);
+    return true;
+}
+
+void DeadlineTracker::place(size_t pos, const HeapNode& node) {
+    m_heap[pos] = node;
+    m_heap_pos[node.slot] = static_cast<uint32_t>(pos);
+}
+
+void DeadlineTracker::sift_up(size_t pos) {
+    HeapNode node = m_heap[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (!(node.deadline < m_heap[parent].deadline)) {
+            break;
+        }
+        place(pos, m_heap[parent]);
+        pos = parent;
+    }
+    place(pos, node);
+}
+
+void DeadlineTracker::sift_down(size_t pos) {
+    HeapNode node = m_heap[pos];
+    size_t size = m_heap.size();
+    while (true) {
+        size_t child = 2 * pos + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && m_heap[child + 1].deadline < m_heap[child].deadline) {
+            child++;
+        }
+        if (!(m_heap[child].deadline < node.deadline)) {
+            break;
+        }
+        place(pos, m_heap[child]);
+        pos = child;
+    }
+    place(pos, node);
+}
+
+void DeadlineTracker::erase_at(size_t pos) {
+    m_heap_pos[m_heap[pos].slot] = NOT_WATCHED;
+    size_t last = m_heap.size() - 1;
+    if (pos != last) {
+        place(pos, m_heap[last]);
+        m_heap.pop_back();
+        // The moved node may belong either above or below its new position
+        sift_up(pos);
+        sift_down(m_heap_pos[m_heap[pos].slot]);
+    } else {
+        m_heap.pop_back();
+    }
+}
+
+void DeadlineTracker::arm() {
+    // Caller holds m_mutex
+    if (m_status != SUCCESS) {
+        return;
+    }
+
+    itimerspec spec{};
+    if (m_heap.empty()) {
+        m_armed = Clock::time_point::max(); // All zero disarms the timer
+    } else {
+        m_armed = m_heap.front().deadline;
+        auto since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(m_armed.time_since_epoch()).count();
+        // An all-zero it_value would disarm the timer instead of firing immediately
+        since_epoch = std::max<int64_t>(since_epoch, 1);
+        spec.it_value.tv_sec = static_cast<time_t>(since_epoch / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(since_epoch % 1000000000);
+    }
+    timerfd_settime(m_timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void DeadlineTracker::run() {
+    std::vector<uint64_t> expired;
+    expired.reserve(m_heap_pos.size());
+    epoll_event events[2];
+    while (true) {
+        int count = epoll_wait(m_epoll_fd, events, 2, -1);
+        bool timer_fired = false;
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd == m_wake_fd) {
+                return;
+            }
+            timer_fired = true;
+        }
+        if (!timer_fired) {
+            continue; // Interrupted by a signal
+        }
+
+        uint64_t expirations;
+        [[maybe_unused]] ssize_t res = read(m_timer_fd, &expirations, sizeof(expirations));
+
+        expired.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Clock::time_point now = Clock::now();
+            while (!m_heap.empty() && m_heap.front().deadline <= now) {
+                expired.push_back(m_heap.front().ticket);
+                erase_at(0);
+            }
+            arm();
+        }
+
+        for (uint64_t ticket : expired) {
+            m_on_expired(ticket);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef RAPIDCDH_DEADLINETRACKER_H
+#define RAPIDCDH_DEADLINETRACKER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../globals.h"
+
+// Watches deadlines with a single timerfd, armed for the earliest one, and one thread blocked in epoll_wait. Nothing
+// polls: the thread only wakes when a deadline passes or the tracker is destroyed.
+//
+// Each deadline belongs to one of capacity slots, such as the owner's job slots, and sits in a min-heap that is
+// allocated with the tracker, so watching and unwatching never touch the heap.
+class DeadlineTracker {
+public:
+    using Clock = std::chrono::steady_clock; // CLOCK_MONOTONIC, the clock the timerfd uses
+    // Called on the tracker thread, without the tracker's lock held
+    using ExpiryHandler = std::function<void(uint64_t ticket)>;
+
+    DeadlineTracker(ExpiryHandler on_expired, size_t capacity);
+    ~DeadlineTracker();
+
+    DeadlineTracker(const DeadlineTracker&) = delete;
+    DeadlineTracker& operator=(const DeadlineTracker&) = delete;
+
+    // FAILURE if the timerfd, eventfd or epoll instance could not be created; nothing will ever expire
+    [[nodiscard]] Status init();
+
+    // Calls on_expired(ticket) once deadline has passed, unless unwatch(slot) is called first. Replaces any deadline
+    // the slot already had. slot must be below capacity. O(log n)
+    void watch(uint32_t slot, uint64_t ticket, Clock::time_point deadline);
+    // Returns false if the slot had no deadline, e.g. because it already expired. O(log n)
+    bool unwatch(uint32_t slot);
+
+private:
+    static constexpr uint32_t NOT_WATCHED = UINT32_MAX;
+
+    struct HeapNode {
+        Clock::time_point deadline;
+        uint64_t ticket;
+        uint32_t slot;
+    };
+
+    void place(size_t pos, const HeapNode& node);
+    void sift_up(size_t pos);
+    void sift_down(size_t pos);
+    void erase_at(size_t pos);
+    void arm();
+    void run();
+
+    ExpiryHandler m_on_expired;
+    Status m_status = SUCCESS;
+    int m_timer_fd = -1;
+    int m_wake_fd = -1; // eventfd that interrupts epoll_wait on shutdown
+    int m_epoll_fd = -1;
+
+    std::mutex m_mutex;
+    std::vector<HeapNode> m_heap; // Reserved for every slot
+    std::vector<uint32_t> m_heap_pos; // Per slot: its node in m_heap, or NOT_WATCHED
+    Clock::time_point m_armed = Clock::time_point::max();
+    std::thread m_thread;
+};
+
+
+#endif //RAPIDCDH_DEADLINETRACKER_H
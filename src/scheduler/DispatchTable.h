@@ -0,0 +1,213 @@
+#ifndef RAPIDCDH_DISPATCHTABLE_H
+#define RAPIDCDH_DISPATCHTABLE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "../globals.h"
+#include "Command.h"
+
+// Reads little-endian fields from a command's params in order. Reading past the end yields zero and marks the reader
+// failed, so a decoder can read every field and check once at the end
+class ParamReader {
+public:
+    explicit constexpr ParamReader(const Command& cmd) : m_data(cmd.params), m_len(cmd.params_len) {}
+
+    template <typename T>
+    constexpr T read() {
+        static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "params are integers or enums");
+        using Int = typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>, std::type_identity<T>>::type;
+        using Raw = std::make_unsigned_t<Int>;
+        if (m_len - m_pos < sizeof(T)) {
+            m_failed = true;
+            m_pos = m_len;
+            return T{};
+        }
+
+        Raw raw = 0;
+        for (size_t i = 0; i < sizeof(T); i++) {
+            raw |= static_cast<Raw>(static_cast<Raw>(m_data[m_pos + i]) << (8 * i));
+        }
+        m_pos += sizeof(T);
+        return static_cast<T>(raw);
+    }
+
+    // Every field was present and no bytes were left over
+    [[nodiscard]] constexpr bool complete() const {
+        return !m_failed && m_pos == m_len;
+    }
+
+private:
+    const uint8_t* m_data;
+    size_t m_len;
+    size_t m_pos = 0;
+    bool m_failed = false;
+};
+
+// A handler takes its context (the drivers), the decoded params and the response to fill in, and returns the status
+// the response carries:
+//
+//   Status handler(Context& context, const Params& params, Response& response);
+//
+// Params is a struct that decodes itself and rejects out-of-range values:
+//
+//   static Status decode(ParamReader& in, Params& params);
+template <typename Handler>
+struct HandlerTraits;
+
+template <typename C, typename P>
+struct HandlerTraits<Status (*)(C&, const P&, Response&)> {
+    using Context = C;
+    using Params = P;
+};
+
+// Decodes cmd's params as Params. INVALID_INPUT if any field is missing or there are bytes left over
+template <typename Params>
+Status decode_params(const Command& cmd, Params& params) {
+    ParamReader in(cmd);
+    Status status = Params::decode(in, params);
+    if (status == SUCCESS && !in.complete()) {
+        return INVALID_INPUT;
+    }
+    return status;
+}
+
+template <typename C>
+struct Route {
+    using Context = C;
+    using Handler = Response (*)(Context&, const Command&);
+    using Check = Status (*)(const Command&);
+
+    uint8_t subsystem_id;
+    uint8_t cmd_num;
+    Handler handler;
+    Check check; // Decodes the params without running the handler
+    ResourceMask resources; // The buses or devices the handler uses, so that only conflicting commands are serialized
+};
+
+namespace dispatch_detail {
+    template <auto Fn>
+    Response invoke(typename HandlerTraits<decltype(Fn)>::Context& context, const Command& cmd) {
+        Response response{cmd.subsystem_id, cmd.cmd_id, SUCCESS, 0, nullptr, 0};
+        typename HandlerTraits<decltype(Fn)>::Params params{};
+        Status status = decode_params(cmd, params);
+        response.status = status == SUCCESS ? Fn(context, params, response) : status;
+        return response;
+    }
+
+    template <auto Fn>
+    Status check(const Command& cmd) {
+        typename HandlerTraits<decltype(Fn)>::Params params{};
+        return decode_params(cmd, params);
+    }
+}
+
+// Routes (subsystem_id, cmd_num) to Fn, with its params decoded to the type Fn takes
+template <auto Fn>
+constexpr auto route(uint8_t subsystem_id, uint8_t cmd_num, ResourceMask resources = 0) {
+    using Context = typename HandlerTraits<decltype(Fn)>::Context;
+    return Route<Context>{subsystem_id, cmd_num, &dispatch_detail::invoke<Fn>, &dispatch_detail::check<Fn>, resources};
+}
+
+// Flat table of handlers built at compile time. Each subsystem owns a contiguous run of slots, one per cmd_num up to
+// the highest it routes, so finding a handler is two small array reads and one indexed call. Pairs without a route,
+// including gaps between cmd_nums, land on a handler that answers CMD_UNKNOWN.
+// Build one with make_dispatch_table
+template <typename Context, size_t Slots>
+class DispatchTable {
+public:
+    using RouteType = Route<Context>;
+
+    static_assert(Slots < 65536, "slot offsets are 16 bits");
+
+    template <size_t N>
+    constexpr explicit DispatchTable(const std::array<RouteType, N>& routes) {
+        for (const RouteType& r : routes) {
+            m_count[r.subsystem_id] = std::max<uint16_t>(m_count[r.subsystem_id], r.cmd_num + 1);
+        }
+        uint16_t base = 0;
+        for (size_t s = 0; s < m_base.size(); s++) {
+            m_base[s] = base;
+            base += m_count[s];
+        }
+
+        m_handlers.fill(&reject);
+        m_checks.fill(&reject_check);
+        for (const RouteType& r : routes) {
+            size_t i = m_base[r.subsystem_id] + r.cmd_num;
+            if (m_handlers[i] != &reject) {
+                throw "two routes for the same subsystem_id and cmd_num"; // Fails compilation
+            }
+            m_handlers[i] = r.handler;
+            m_checks[i] = r.check;
+            m_resources[i] = r.resources;
+        }
+    }
+
+    // SUCCESS if the command has a route and its params decode; CMD_UNKNOWN or INVALID_INPUT otherwise.
+    // For rejecting commands before they are queued
+    [[nodiscard]] Status check(const Command& cmd) const {
+        return m_checks[slot(cmd.subsystem_id, cmd.cmd_num)](cmd);
+    }
+
+    [[nodiscard]] constexpr bool contains(uint8_t subsystem_id, uint8_t cmd_num) const {
+        return m_handlers[slot(subsystem_id, cmd_num)] != &reject;
+    }
+
+    // What the command's route declared it uses; nothing for a command without a route, which is rejected at once
+    [[nodiscard]] constexpr ResourceMask resources(const Command& cmd) const {
+        return m_resources[slot(cmd.subsystem_id, cmd.cmd_num)];
+    }
+
+    Response dispatch(Context& context, const Command& cmd) const {
+        return m_handlers[slot(cmd.subsystem_id, cmd.cmd_num)](context, cmd);
+    }
+
+private:
+    static Response reject(Context&, const Command& cmd) {
+        return {cmd.subsystem_id, cmd.cmd_id, CMD_UNKNOWN, 0, nullptr, 0};
+    }
+
+    static Status reject_check(const Command&) {
+        return CMD_UNKNOWN;
+    }
+
+    // Unrouted subsystems have a count of 0, so they fall through to the sentinel slot at the end
+    constexpr size_t slot(uint8_t subsystem_id, uint8_t cmd_num) const {
+        return cmd_num < m_count[subsystem_id] ? m_base[subsystem_id] + cmd_num : Slots;
+    }
+
+    std::array<uint16_t, 256> m_base{};
+    std::array<uint16_t, 256> m_count{};
+    std::array<typename RouteType::Handler, Slots + 1> m_handlers{};
+    std::array<typename RouteType::Check, Slots + 1> m_checks{};
+    std::array<ResourceMask, Slots + 1> m_resources{};
+};
+
+namespace dispatch_detail {
+    template <typename RouteType, size_t N>
+    consteval size_t slots(const std::array<RouteType, N>& routes) {
+        std::array<size_t, 256> count{};
+        for (const RouteType& r : routes) {
+            count[r.subsystem_id] = std::max<size_t>(count[r.subsystem_id], r.cmd_num + 1);
+        }
+        size_t total = 0;
+        for (size_t c : count) {
+            total += c;
+        }
+        return total;
+    }
+}
+
+// Routes must be a constexpr std::array of route<...>() entries with static storage duration
+template <const auto& Routes>
+consteval auto make_dispatch_table() {
+    using Context = typename std::remove_cvref_t<decltype(Routes)>::value_type::Context;
+    return DispatchTable<Context, dispatch_detail::slots(Routes)>(Routes);
+}
+
+
+#endif //RAPIDCDH_DISPATCHTABLE_H
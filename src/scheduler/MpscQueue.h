@@ -0,0 +1,84 @@
+#ifndef RAPIDCDH_MPSCQUEUE_H
+#define RAPIDCDH_MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bounded lock-free queue for many producer threads and one consumer thread. Each cell carries a sequence number that
+// tells producers and the consumer whose turn it is, so neither side ever waits on a lock; a full queue fails the push.
+template <typename T>
+class MpscQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit MpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        m_mask = size - 1;
+        m_cells = std::make_unique<Cell[]>(size);
+        for (size_t i = 0; i < size; i++) {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Any thread. Returns false if the queue is full
+    bool try_push(const T& value) {
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                // The cell is free for this lap; claim it
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // The consumer has not emptied this cell since the last lap
+                return false;
+            } else {
+                // Another producer claimed the cell first
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = value;
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Returns false if the queue is empty or the next value is still being written
+    bool try_pop(T& value) {
+        Cell& cell = m_cells[m_head & m_mask];
+        if (cell.seq.load(std::memory_order_acquire) != m_head + 1) {
+            return false;
+        }
+
+        value = cell.value;
+        cell.seq.store(m_head + m_mask + 1, std::memory_order_release);
+        m_head++;
+        return true;
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return m_mask + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+    alignas(64) std::atomic<size_t> m_tail{0}; // Next position producers write
+    alignas(64) size_t m_head = 0; // Next position the consumer reads
+};
+
+
+#endif //RAPIDCDH_MPSCQUEUE_H
@@ -0,0 +1,137 @@
+#include "PayloadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+PayloadPool::Slab::Slab(const SizeClass& size_class, size_t offset)
+    : block_size(size_class.block_size), block_count(size_class.block_count), offset(offset),
+      head(size_class.block_count > 0 ? 0 : NIL),
+      next(std::make_unique<std::atomic<uint32_t>[]>(size_class.block_count)),
+      allocated(std::make_unique<std::atomic<bool>[]>(size_class.block_count)) {
+    // Low blocks are handed out first
+    for (uint32_t i = 0; i < block_count; i++) {
+        next[i].store(i + 1 < block_count ? i + 1 : NIL, std::memory_order_relaxed);
+        allocated[i].store(false, std::memory_order_relaxed);
+    }
+}
+
+bool PayloadPool::Slab::pop(uint32_t& block) {
+    uint64_t top = head.load(std::memory_order_acquire);
+    while (true) {
+        block = static_cast<uint32_t>(top);
+        if (block == NIL) {
+            return false;
+        }
+        // next may be stale if another thread takes the block first; the change count then fails the exchange
+        uint64_t below = next[block].load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(top, ((top >> 32) + 1) << 32 | below, std::memory_order_acquire,
+                                       std::memory_order_acquire)) {
+            return true;
+        }
+    }
+}
+
+void PayloadPool::Slab::push(uint32_t block) {
+    uint64_t top = head.load(std::memory_order_relaxed);
+    do {
+        next[block].store(static_cast<uint32_t>(top), std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(top, ((top >> 32) + 1) << 32 | block, std::memory_order_release,
+                                         std::memory_order_relaxed));
+}
+
+PayloadPool::PayloadPool(std::vector<SizeClass> classes) {
+    m_slabs.reserve(classes.size());
+    for (const SizeClass& size_class : classes) {
+        m_slabs.push_back(std::make_unique<Slab>(size_class, m_capacity));
+        m_capacity += static_cast<size_t>(size_class.block_size) * size_class.block_count;
+    }
+
+    m_memory = std::make_unique<uint8_t[]>(m_capacity);
+}
+
+Status PayloadPool::allocate(uint32_t len, uint8_t*& data) {
+    for (const std::unique_ptr<Slab>& slab : m_slabs) {
+        uint32_t block;
+        if (slab->block_size < len || !slab->pop(block)) {
+            continue;
+        }
+
+        slab->allocated[block].store(true, std::memory_order_relaxed);
+        raise(slab->high_water, slab->in_use.fetch_add(1, std::memory_order_relaxed) + 1);
+        size_t bytes = m_bytes_in_use.fetch_add(slab->block_size, std::memory_order_relaxed) + slab->block_size;
+        size_t high = m_bytes_high_water.load(std::memory_order_relaxed);
+        while (high < bytes && !m_bytes_high_water.compare_exchange_weak(high, bytes, std::memory_order_relaxed)) {
+        }
+
+        data = m_memory.get() + slab->offset + static_cast<size_t>(block) * slab->block_size;
+        return SUCCESS;
+    }
+
+    m_failed_allocations.fetch_add(1, std::memory_order_relaxed);
+    return POOL_EXHAUSTED;
+}
+
+void PayloadPool::release(const uint8_t* data) {
+    if (!owns(data)) {
+        return;
+    }
+
+    size_t offset = data - m_memory.get();
+    for (const std::unique_ptr<Slab>& slab : m_slabs) {
+        size_t end = slab->offset + static_cast<size_t>(slab->block_size) * slab->block_count;
+        if (offset >= end) {
+            continue;
+        }
+
+        size_t block = (offset - slab->offset) / slab->block_size;
+        // The exchange lets exactly one of two racing releases of the same block through
+        if ((offset - slab->offset) % slab->block_size != 0 ||
+            !slab->allocated[block].exchange(false, std::memory_order_relaxed)) {
+            m_rejected_releases.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        slab->in_use.fetch_sub(1, std::memory_order_relaxed);
+        m_bytes_in_use.fetch_sub(slab->block_size, std::memory_order_relaxed);
+        slab->push(static_cast<uint32_t>(block));
+        return;
+    }
+}
+
+bool PayloadPool::owns(const uint8_t* data) const {
+    // Compare as integers; relational comparison of unrelated pointers is unspecified
+    auto address = reinterpret_cast<uintptr_t>(data);
+    auto begin = reinterpret_cast<uintptr_t>(m_memory.get());
+    return data != nullptr && address >= begin && address < begin + m_capacity;
+}
+
+PayloadPool::Stats PayloadPool::stats() const {
+    Stats stats{{},
+                m_bytes_in_use.load(std::memory_order_relaxed),
+                m_bytes_high_water.load(std::memory_order_relaxed),
+                m_capacity,
+                m_failed_allocations.load(std::memory_order_relaxed),
+                m_rejected_releases.load(std::memory_order_relaxed)};
+    stats.classes.reserve(m_slabs.size());
+    for (const std::unique_ptr<Slab>& slab : m_slabs) {
+        stats.classes.push_back({slab->block_size, slab->block_count, slab->in_use.load(std::memory_order_relaxed),
+                                 slab->high_water.load(std::memory_order_relaxed)});
+    }
+
+    return stats;
+}
+
+void PayloadPool::raise(std::atomic<uint32_t>& high_water, uint32_t value) {
+    uint32_t high = high_water.load(std::memory_order_relaxed);
+    while (high < value && !high_water.compare_exchange_weak(high, value, std::memory_order_relaxed)) {
+    }
+}
+
+std::vector<PayloadPool::SizeClass> PayloadPool::default_classes() {
+    // ~1.4 MB in total. Command parameters are usually a few bytes; the large classes are for bulk responses
+    return {
+        {32,    1024},
+        {256,   512},
+        {2048,  128},
+        {65536, 16},
+    };
+}
@@ -0,0 +1,91 @@
+#ifndef RAPIDCDH_PAYLOADPOOL_H
+#define RAPIDCDH_PAYLOADPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../globals.h"
+
+// Fixed-capacity slab pool for command and response payloads. All memory is allocated once in the constructor and
+// split into size classes of equal blocks; allocate and release never touch the heap afterwards.
+// Thread-safe without locks: each size class keeps its free blocks on a lock-free stack whose head carries a change
+// count, so producers on any thread can allocate params while the dispatch thread releases them.
+class PayloadPool {
+public:
+    struct SizeClass {
+        uint32_t block_size; // Bytes
+        uint32_t block_count;
+    };
+
+    struct ClassStats {
+        uint32_t block_size;
+        uint32_t block_count;
+        uint32_t in_use;
+        uint32_t high_water; // Most blocks ever in use at once
+    };
+
+    // Counters are read one at a time, so while other threads allocate they need not add up exactly
+    struct Stats {
+        std::vector<ClassStats> classes;
+        size_t bytes_in_use; // Block bytes, not requested bytes
+        size_t bytes_high_water;
+        size_t capacity;
+        uint64_t failed_allocations; // Requests that found no free block large enough
+        uint64_t rejected_releases;  // Releases ignored: inside a block rather than at its start, or already free
+    };
+
+    // Size classes must be listed in increasing block_size order
+    explicit PayloadPool(std::vector<SizeClass> classes = default_classes());
+
+    PayloadPool(const PayloadPool&) = delete;
+    PayloadPool& operator=(const PayloadPool&) = delete;
+
+    // Hands out a block of at least len bytes from the smallest class that has one free. O(number of classes)
+    [[nodiscard]] Status allocate(uint32_t len, uint8_t*& data);
+    // Returns a block to the pool. Only the pointer allocate handed out releases a block, and only once: pointers the
+    // pool does not own are ignored, and pointers inside a block, such as payloads decoded in place from a pooled
+    // receive buffer, or to a block already free, are ignored and counted. O(number of classes)
+    void release(const uint8_t* data);
+
+    [[nodiscard]] bool owns(const uint8_t* data) const;
+    [[nodiscard]] Stats stats() const;
+
+    static std::vector<SizeClass> default_classes();
+
+private:
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Slab {
+        Slab(const SizeClass& size_class, size_t offset);
+
+        bool pop(uint32_t& block);
+        void push(uint32_t block);
+
+        uint32_t block_size;
+        uint32_t block_count;
+        size_t offset; // Start of the slab in m_memory
+        // Top free block index in the low 32 bits, and a count of changes in the high 32, so that a pop that read a
+        // stale next link cannot succeed after the block was popped and pushed back in the meantime
+        alignas(64) std::atomic<uint64_t> head;
+        std::unique_ptr<std::atomic<uint32_t>[]> next; // Per block: the free block below it on the stack
+        std::unique_ptr<std::atomic<bool>[]> allocated; // Per block, so that a second release of the same block is caught
+        std::atomic<uint32_t> in_use{0};
+        std::atomic<uint32_t> high_water{0};
+    };
+
+    static void raise(std::atomic<uint32_t>& high_water, uint32_t value);
+
+    std::vector<std::unique_ptr<Slab>> m_slabs;
+    std::unique_ptr<uint8_t[]> m_memory;
+    size_t m_capacity = 0;
+    std::atomic<size_t> m_bytes_in_use{0};
+    std::atomic<size_t> m_bytes_high_water{0};
+    std::atomic<uint64_t> m_failed_allocations{0};
+    std::atomic<uint64_t> m_rejected_releases{0};
+};
+
+
+#endif //RAPIDCDH_PAYLOADPOOL_H
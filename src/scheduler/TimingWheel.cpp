@@ -0,0 +1,343 @@
+#include "TimingWheel.h"
+
+#include <algorithm>
+#include <bit>
+
+TimingWheel::TimingWheel() {
+    m_heads.fill(NIL);
+    m_tails.fill(NIL);
+}
+
+TimingWheel::Handle TimingWheel::insert(uint64_t exec_time, uint64_t seq, uint32_t key) {
+    Handle handle;
+    if (m_free != NIL) {
+        handle = m_free;
+        m_free = m_nodes[handle].next;
+    } else {
+        handle = static_cast<Handle>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    Node& node = m_nodes[handle];
+    node.exec_time = exec_time;
+    node.seq = seq;
+    node.key = key;
+    m_size++;
+    place(handle);
+    if (m_earliest_valid) {
+        m_earliest = std::min(m_earliest, exec_time);
+    }
+
+    return handle;
+}
+
+void TimingWheel::cancel(Handle handle) {
+    if (m_nodes[handle].exec_time == m_earliest) {
+        m_earliest_valid = false;
+    }
+    unlink(handle);
+    release(handle);
+}
+
+bool TimingWheel::advance(uint64_t now, std::vector<Expired>& due) {
+    due.clear();
+    for (Handle handle = m_heads[LATE_SLOT]; handle != NIL;) {
+        Node& node = m_nodes[handle];
+        Handle next = node.next;
+        if (node.exec_time <= now) {
+            due.push_back({node.exec_time, node.seq, node.key});
+            unlink(handle);
+            release(handle);
+        }
+        handle = next;
+    }
+    if (!due.empty()) {
+        m_earliest_valid = false;
+        sort_due(due);
+        return true;
+    }
+
+    while (m_current <= now) {
+        if (m_size == 0) {
+            m_current = now + 1;
+            return false;
+        }
+
+        if (m_level_sizes[0] == 0) {
+            // Nothing can expire before the first occupied slot in the upper levels, so skip straight to it
+            uint32_t level = 0;
+            uint64_t next = next_slot_start(level);
+            if (next > now) {
+                move_to(now + 1);
+                return false;
+            }
+            if (level == LEVELS - 1 && m_overflow > 0 && m_level_sizes[1] + m_level_sizes[2] + m_level_sizes[3] == 0) {
+                // Only the top level is occupied and it holds parked entries, which would otherwise be re-parked
+                // once per 2^32 ms skipped. Re-place the whole top level at once instead
+                uint64_t earliest_time;
+                earliest(earliest_time);
+                m_current = std::min(earliest_time, now + 1);
+                for (uint32_t i = 0; i < LEVEL_SLOTS; i++) {
+                    cascade(LEVELS - 1, static_cast<uint64_t>(i) << shift(LEVELS - 1));
+                }
+                continue;
+            }
+            move_to(next);
+        } else {
+            // Skip empty level 0 slots, but stop at the end of the level 0 window so that the upper levels cascade
+            uint32_t from = static_cast<uint32_t>(m_current & (LEVEL0_SLOTS - 1));
+            uint32_t slot = from;
+            for (; slot < LEVEL0_SLOTS; slot = (slot & ~63u) + 64) {
+                uint64_t bits = m_level0_occupied[slot / 64] & (~0ULL << (slot % 64));
+                if (bits) {
+                    slot = (slot & ~63u) + std::countr_zero(bits);
+                    break;
+                }
+            }
+            move_to(std::min(m_current + (slot - from), now + 1));
+            if (m_current > now) {
+                return false;
+            }
+        }
+
+        uint64_t tick = m_current;
+        uint32_t slot = slot_index(0, tick);
+        Handle handle = m_heads[slot];
+        while (handle != NIL) {
+            Node& node = m_nodes[handle];
+            Handle next = node.next;
+            due.push_back({node.exec_time, node.seq, node.key});
+            m_level_sizes[0]--;
+            release(handle);
+            handle = next;
+        }
+        m_heads[slot] = NIL;
+        m_tails[slot] = NIL;
+        m_level0_occupied[slot / 64] &= ~(1ULL << (slot % 64));
+        move_to(tick + 1);
+
+        if (!due.empty()) {
+            // Cascaded entries are appended behind ones inserted directly, so restore insertion order
+            m_earliest_valid = false;
+            sort_due(due);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TimingWheel::earliest(uint64_t& exec_time) const {
+    if (m_size == 0) {
+        return false;
+    }
+
+    if (!m_earliest_valid) {
+        m_earliest = find_earliest();
+        m_earliest_valid = true;
+    }
+    exec_time = m_earliest;
+    return true;
+}
+
+size_t TimingWheel::size() const {
+    return m_size;
+}
+
+uint32_t TimingWheel::shift(uint32_t level) {
+    return level == 0 ? 0 : LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+}
+
+uint32_t TimingWheel::slot_index(uint32_t level, uint64_t time) {
+    if (level == 0) {
+        return static_cast<uint32_t>(time & (LEVEL0_SLOTS - 1));
+    }
+    return LEVEL0_SLOTS + (level - 1) * LEVEL_SLOTS + static_cast<uint32_t>((time >> shift(level)) & (LEVEL_SLOTS - 1));
+}
+
+void TimingWheel::sort_due(std::vector<Expired>& due) {
+    std::sort(due.begin(), due.end(), [](const Expired& a, const Expired& b) {
+        return a.exec_time < b.exec_time || (a.exec_time == b.exec_time && a.seq < b.seq);
+    });
+}
+
+void TimingWheel::place(Handle handle) {
+    Node& node = m_nodes[handle];
+    if (node.exec_time < m_current) {
+        // The wheel has already passed this tick
+        node.expires = node.exec_time;
+        link(handle, LATE_SLOT);
+        return;
+    }
+
+    uint64_t expires = node.exec_time;
+    if (expires - m_current >= MAX_DELTA) {
+        // Too far out to place exactly; park it in the top level and re-place it when that slot cascades
+        expires = m_current + MAX_DELTA - 1;
+    }
+    node.expires = expires;
+
+    uint64_t delta = expires - m_current;
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && delta >= (1ULL << shift(level + 1))) {
+        level++;
+    }
+    link(handle, slot_index(level, expires));
+}
+
+void TimingWheel::link(Handle handle, uint32_t slot) {
+    Node& node = m_nodes[handle];
+    node.slot = static_cast<uint16_t>(slot);
+    node.prev = m_tails[slot];
+    node.next = NIL;
+    if (m_tails[slot] != NIL) {
+        m_nodes[m_tails[slot]].next = handle;
+    } else {
+        m_heads[slot] = handle;
+    }
+    m_tails[slot] = handle;
+    if (node.exec_time > node.expires) {
+        m_overflow++;
+    }
+
+    if (slot == LATE_SLOT) {
+        return;
+    }
+    if (slot < LEVEL0_SLOTS) {
+        m_level_sizes[0]++;
+        m_level0_occupied[slot / 64] |= 1ULL << (slot % 64);
+    } else {
+        m_level_sizes[1 + (slot - LEVEL0_SLOTS) / LEVEL_SLOTS]++;
+    }
+}
+
+void TimingWheel::unlink(Handle handle) {
+    Node& node = m_nodes[handle];
+    uint32_t slot = node.slot;
+    if (node.prev != NIL) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_heads[slot] = node.next;
+    }
+    if (node.next != NIL) {
+        m_nodes[node.next].prev = node.prev;
+    } else {
+        m_tails[slot] = node.prev;
+    }
+    if (node.exec_time > node.expires) {
+        m_overflow--;
+    }
+
+    if (slot == LATE_SLOT) {
+        return;
+    }
+    if (slot < LEVEL0_SLOTS) {
+        m_level_sizes[0]--;
+        if (m_heads[slot] == NIL) {
+            m_level0_occupied[slot / 64] &= ~(1ULL << (slot % 64));
+        }
+    } else {
+        m_level_sizes[1 + (slot - LEVEL0_SLOTS) / LEVEL_SLOTS]--;
+    }
+}
+
+void TimingWheel::release(Handle handle) {
+    Node& node = m_nodes[handle];
+    node.slot = FREE;
+    node.next = m_free;
+    m_free = handle;
+    m_size--;
+}
+
+void TimingWheel::cascade(uint32_t level, uint64_t time) {
+    uint32_t slot = slot_index(level, time);
+    Handle handle = m_heads[slot];
+    m_heads[slot] = NIL;
+    m_tails[slot] = NIL;
+    while (handle != NIL) {
+        Node& node = m_nodes[handle];
+        Handle next = node.next;
+        m_level_sizes[level]--;
+        if (node.exec_time > node.expires) {
+            m_overflow--;
+        }
+        place(handle);
+        handle = next;
+    }
+}
+
+void TimingWheel::move_to(uint64_t time) {
+    // Only valid when nothing expires before time. Each level whose current slot changes cascades the slot that time
+    // falls in; any slots skipped over are empty. Top level first, so that entries can fall through several levels
+    uint64_t previous = m_current;
+    m_current = time;
+    for (uint32_t level = LEVELS - 1; level > 0; level--) {
+        if ((time >> shift(level)) != (previous >> shift(level))) {
+            cascade(level, time);
+        }
+    }
+}
+
+uint64_t TimingWheel::next_slot_start(uint32_t& level) const {
+    // Within an upper level, slots hold consecutive time ranges in circular order starting after the current slot
+    uint64_t next = UINT64_MAX;
+    for (uint32_t l = 1; l < LEVELS; l++) {
+        if (m_level_sizes[l] == 0) {
+            continue;
+        }
+        for (uint64_t i = 1; i <= LEVEL_SLOTS; i++) {
+            uint64_t start = ((m_current >> shift(l)) + i) << shift(l);
+            if (m_heads[slot_index(l, start)] != NIL) {
+                if (start < next) {
+                    next = start;
+                    level = l;
+                }
+                break;
+            }
+        }
+    }
+
+    return next;
+}
+
+uint64_t TimingWheel::find_earliest() const {
+    uint64_t earliest = UINT64_MAX;
+    for (Handle handle = m_heads[LATE_SLOT]; handle != NIL; handle = m_nodes[handle].next) {
+        earliest = std::min(earliest, m_nodes[handle].exec_time);
+    }
+
+    // Every entry in a level 0 slot expires on that tick
+    for (uint64_t i = 0; m_level_sizes[0] > 0 && i < LEVEL0_SLOTS; i++) {
+        if (m_heads[slot_index(0, m_current + i)] != NIL) {
+            earliest = std::min(earliest, m_current + i);
+            break;
+        }
+    }
+
+    // In the upper levels only the first occupied slot needs scanning, and only if it can beat what was found below.
+    // Parked entries are ordered by when they were parked rather than by exec_time, so they are all checked
+    for (uint32_t level = 1; level < LEVELS; level++) {
+        if (m_level_sizes[level] == 0) {
+            continue;
+        }
+        bool scan_all = level == LEVELS - 1 && m_overflow > 0;
+        for (uint64_t i = 1; i <= LEVEL_SLOTS; i++) {
+            uint64_t start = ((m_current >> shift(level)) + i) << shift(level);
+            Handle handle = m_heads[slot_index(level, start)];
+            if (handle == NIL) {
+                continue;
+            }
+            if (!scan_all && start >= earliest) {
+                break;
+            }
+            for (; handle != NIL; handle = m_nodes[handle].next) {
+                earliest = std::min(earliest, m_nodes[handle].exec_time);
+            }
+            if (!scan_all) {
+                break;
+            }
+        }
+    }
+
+    return earliest;
+}
@@ -0,0 +1,90 @@
+#ifndef RAPIDCDH_TIMINGWHEEL_H
+#define RAPIDCDH_TIMINGWHEEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel with 1 ms ticks. Level 0 has 256 slots of 1 ms, and each of the four levels above it has
+// 64 slots covering 64 times the span of the level below, so entries up to 2^32 ms (~49.7 days) ahead are placed
+// exactly. Entries further out are parked in the top level and re-placed as time advances.
+// Entries only move down a level when the wheel reaches their slot (lazy cascading).
+class TimingWheel {
+public:
+    using Handle = uint32_t;
+
+    struct Expired {
+        uint64_t exec_time;
+        uint64_t seq;
+        uint32_t key;
+    };
+
+    TimingWheel();
+
+    // Adds an entry that expires at exec_time (ms). Entries for ticks the wheel has already passed are kept aside and
+    // expire on the next call to advance. O(1)
+    Handle insert(uint64_t exec_time, uint64_t seq, uint32_t key);
+    // Removes an entry that has not expired yet. O(1)
+    void cancel(Handle handle);
+
+    // Advances the wheel towards now (ms), stopping after the first tick that has expired entries. Those entries are
+    // removed from the wheel and written to due, ordered by (exec_time, seq).
+    // Returns false once every tick up to and including now has been processed
+    bool advance(uint64_t now, std::vector<Expired>& due);
+
+    // Earliest exec_time of any entry in the wheel; false if the wheel is empty. Cached until that entry leaves
+    bool earliest(uint64_t& exec_time) const;
+
+    [[nodiscard]] size_t size() const;
+
+private:
+    static constexpr uint32_t LEVELS = 5;
+    static constexpr uint32_t LEVEL0_BITS = 8;
+    static constexpr uint32_t LEVEL_BITS = 6;
+    static constexpr uint32_t LEVEL0_SLOTS = 1 << LEVEL0_BITS;
+    static constexpr uint32_t LEVEL_SLOTS = 1 << LEVEL_BITS;
+    static constexpr uint32_t LATE_SLOT = LEVEL0_SLOTS + (LEVELS - 1) * LEVEL_SLOTS; // Entries the wheel has passed
+    static constexpr uint32_t NUM_SLOTS = LATE_SLOT + 1;
+    static constexpr uint64_t MAX_DELTA = 1ULL << (LEVEL0_BITS + (LEVELS - 1) * LEVEL_BITS);
+    static constexpr Handle NIL = UINT32_MAX;
+    static constexpr uint16_t FREE = UINT16_MAX;
+
+    struct Node {
+        uint64_t exec_time;
+        uint64_t expires; // exec_time clamped to the range the wheel can hold
+        uint64_t seq;
+        uint32_t key;
+        Handle prev;
+        Handle next; // Next node in the slot, or in the free list
+        uint16_t slot; // FREE if the node is not in the wheel
+    };
+
+    static uint32_t shift(uint32_t level);
+    static uint32_t slot_index(uint32_t level, uint64_t time);
+    static void sort_due(std::vector<Expired>& due);
+
+    void place(Handle handle);
+    void link(Handle handle, uint32_t slot);
+    void unlink(Handle handle);
+    void release(Handle handle);
+    void cascade(uint32_t level, uint64_t time);
+    void move_to(uint64_t time);
+    uint64_t next_slot_start(uint32_t& level) const;
+    uint64_t find_earliest() const;
+
+    std::vector<Node> m_nodes;
+    Handle m_free = NIL;
+    std::array<Handle, NUM_SLOTS> m_heads{};
+    std::array<Handle, NUM_SLOTS> m_tails{};
+    std::array<size_t, LEVELS> m_level_sizes{};
+    std::array<uint64_t, LEVEL0_SLOTS / 64> m_level0_occupied{}; // Bitmap of non-empty level 0 slots
+    uint64_t m_current = 0; // Next tick to be processed
+    size_t m_size = 0;
+    size_t m_overflow = 0; // Entries parked in the top level because they are too far out
+    mutable uint64_t m_earliest = 0;
+    mutable bool m_earliest_valid = false;
+};
+
+
+#endif //RAPIDCDH_TIMINGWHEEL_H
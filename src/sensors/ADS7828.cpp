@@ -1,66 +1,78 @@
 #include "ADS7828.h"
 
+#include <array>
+#include <bit>
 #include <cstdint>
-#include <wiringPi.h>
-#include <wiringPiI2C.h>
 
 #include "../globals.h"
+#include "Conversion.h"
 
 const int MAX_READ_VALUE = (1 << 12) - 1;
 
-ADS7828::ADS7828(const char* device, bool addr1, bool addr2, double referenceVoltage) {
-	uint8_t address = static_cast<uint8_t>(0b01001000 + 2 * addr1 + addr2); // overflow not possible due to math of expression
-	fd = wiringPiI2CSetupInterface(device, address);
+namespace {
+	uint8_t commonAnodeCmd(int channel, bool) {
+		return static_cast<uint8_t>(56 * (channel & 1) + 8 * channel + 140); // overflow not possible due to math of expression and range check on channel
+	}
+
+	uint8_t differentialPairCmd(int pair, bool inverted) {
+		return static_cast<uint8_t>(12 + inverted * 64 + pair * 16); // overflow not possible due to math of expression and range check on pair
+	}
+}
+
+ADS7828::ADS7828(const char* device, bool addr1, bool addr2, double referenceVoltage)
+	: i2c(device, static_cast<uint8_t>(0b01001000 + 2 * addr1 + addr2)) { // overflow not possible due to math of expression
 	this->referenceVoltage = referenceVoltage;
 }
 
 Status ADS7828::init() {
-	return fd == -1 ? I2C_SETUP_FAILURE : SUCCESS;
+	return i2c.init();
 }
 
-Status ADS7828::readChannelCommonAnodeRaw(int channel, uint16_t& value) {
-	if (channel >= 8 || channel < 0) {
-		return INVALID_INPUT; // Bad input: invalid channel
-	}
-	if (fd == -1) {
-		return I2C_SETUP_FAILURE;
-	}
-	uint8_t cmd = static_cast<uint8_t>(56 * (channel & 1) + 8 * channel + 140); // overflow not possible due to math of expression and range check on channel
-	if (cmd != lastCmd) {
-		int res = wiringPiI2CWrite(fd, cmd);
-		if (res < 0) {
-			lastCmd = 255;
-			return I2C_WRITE_FAILURE;
-		}
-	}
-	int res = wiringPiI2CRead(fd);
-	if (res < 0 || res > MAX_READ_VALUE) {
+// The device converts the selected input on every read and sends the result MSB first
+Status ADS7828::parse(const uint8_t* data, uint16_t& value) {
+	int res = data[0] << 8 | data[1];
+	if (res > MAX_READ_VALUE) {
 		return I2C_READ_FAILURE;
 	}
 	value = static_cast<uint16_t>(res); // overflow not possible, range check already occurred
 	return SUCCESS;
 }
 
-Status ADS7828::readChannelCommonAnode(int channel, double& value) {
+// A new command is written in the same transaction as the read (repeated start); when it is already selected the read
+// goes out on its own
+Status ADS7828::convert(uint8_t cmd, uint16_t& value) {
+	std::array<uint8_t, 2> data;
+	if (cmd == lastCmd) {
+		if (i2c.read(data) != SUCCESS) {
+			return I2C_READ_FAILURE;
+		}
+	} else {
+		if (i2c.write_read({&cmd, 1}, data) != SUCCESS) {
+			lastCmd = NO_CMD; // Unknown whether the command got through
+			return I2C_READ_FAILURE;
+		}
+		lastCmd = cmd;
+	}
+	return parse(data.data(), value);
+}
+
+Status ADS7828::readChannelCommonAnodeRaw(int channel, uint16_t& value) {
 	if (channel >= 8 || channel < 0) {
 		return INVALID_INPUT; // Bad input: invalid channel
 	}
-	if (fd == -1) {
+	if (!i2c.is_open()) {
 		return I2C_SETUP_FAILURE;
 	}
-	uint8_t cmd = static_cast<uint8_t>(56 * (channel & 1) + 8 * channel + 140); // overflow not possible due to math of expression and range check on channel
-	if (cmd != lastCmd) {
-		int res = wiringPiI2CWrite(fd, cmd);
-		if (res < 0) {
-			lastCmd = 255;
-			return I2C_WRITE_FAILURE;
-		}
-	}
-	int res = wiringPiI2CRead(fd);
-	if (res < 0 || res > MAX_READ_VALUE) {
-		return I2C_READ_FAILURE;
+	return convert(commonAnodeCmd(channel, false), value);
+}
+
+Status ADS7828::readChannelCommonAnode(int channel, double& value) {
+	uint16_t raw;
+	Status s = readChannelCommonAnodeRaw(channel, raw);
+	if (s != SUCCESS) {
+		return s;
 	}
-	value = res * referenceVoltage / (1 << 12);
+	value = parseRawVoltage(raw);
 	return SUCCESS;
 }
 
@@ -70,23 +82,10 @@ Status ADS7828::readChannelDifferentialPairRaw(int pair, bool inverted, uint16_t
 	if (pair >= 4 || pair < 0) {
 		return INVALID_INPUT; // Bad input: invalid pair
 	}
-	if (fd == -1) {
+	if (!i2c.is_open()) {
 		return I2C_SETUP_FAILURE;
 	}
-	uint8_t cmd = static_cast<uint8_t>(12 + inverted * 64 + pair * 16); // overflow not possible due to math of expression and range check on pair
-	if (cmd != lastCmd) {
-		int res = wiringPiI2CWrite(fd, cmd);
-		if (res < 0) {
-			lastCmd = 255;
-			return I2C_WRITE_FAILURE;
-		}
-	}
-	int res = wiringPiI2CRead(fd);
-	if (res < 0 || res > MAX_READ_VALUE) {
-		return I2C_READ_FAILURE;
-	}
-	value = static_cast<uint16_t>(res); // overflow not possible, range check already occurred
-	return SUCCESS;
+	return convert(differentialPairCmd(pair, inverted), value);
 }
 
 Status ADS7828::readChannelDifferentialPairRaw(int pair, uint16_t& value) {
@@ -96,41 +95,93 @@ Status ADS7828::readChannelDifferentialPairRaw(int pair, uint16_t& value) {
 // pair 0 is 0,1; pair 1 is 2,3; pair 2 is 4,5; pair 3 is 6,7
 // if the pair is inverted, the positive input is the larger channel number
 Status ADS7828::readChannelDifferentialPair(int pair, bool inverted, double& value) {
-	if (pair >= 4 || pair < 0) {
+	uint16_t raw;
+	Status s = readChannelDifferentialPairRaw(pair, inverted, raw);
+	if (s != SUCCESS) {
+		return s;
+	}
+	value = parseRawVoltage(raw);
+	return SUCCESS;
+}
+
+Status ADS7828::readChannelDifferentialPair(int pair, double& value) {
+    return readChannelDifferentialPair(pair, false, value);
+}
+
+Status ADS7828::scanChannels(uint8_t mask, std::span<uint16_t> values) {
+	return scan(mask, 8, &commonAnodeCmd, false, values);
+}
+
+Status ADS7828::scanDifferentialPairs(uint8_t mask, bool inverted, std::span<uint16_t> values) {
+	if (mask >= 1 << 4) {
 		return INVALID_INPUT; // Bad input: invalid pair
 	}
-	if (fd == -1) {
+	return scan(mask, 4, &differentialPairCmd, inverted, values);
+}
+
+// Every conversion is one write and one read message in the same ioctl. Starts from the input that is already
+// selected, if it is in the scan, so that its command is not sent again. Samples still land in input order
+Status ADS7828::scan(uint8_t mask, int count, uint8_t (*command)(int, bool), bool inverted,
+		std::span<uint16_t> values) {
+	if (values.size() < static_cast<size_t>(std::popcount(mask))) {
+		return INVALID_INPUT; // Bad input: not enough room for the samples
+	}
+	if (!i2c.is_open()) {
 		return I2C_SETUP_FAILURE;
 	}
-	uint8_t cmd = static_cast<uint8_t>(12 + inverted * 64 + pair * 16); // overflow not possible due to math of expression and range check on pair
-	if (cmd != lastCmd) {
-		int res = wiringPiI2CWrite(fd, cmd);
-		if (res < 0) {
-			lastCmd = 255;
-			return I2C_WRITE_FAILURE;
+
+	int first = 0;
+	for (int input = 0; input < count; input++) {
+		if ((mask >> input & 1) && command(input, inverted) == lastCmd) {
+			first = input;
+			break;
 		}
 	}
-	int res = wiringPiI2CRead(fd);
-	if (res < 0 || res > MAX_READ_VALUE) {
+	std::array<uint8_t, 8> cmds;
+	std::array<uint8_t, 16> data;
+	std::array<I2CDevice::Message, 16> messages;
+	std::array<size_t, 8> slots;
+	size_t n = 0;
+	size_t m = 0;
+	for (int i = 0; i < count; i++) {
+		int input = (first + i) % count;
+		if (!(mask >> input & 1)) {
+			continue;
+		}
+		cmds[n] = command(input, inverted);
+		if (cmds[n] != (n == 0 ? lastCmd : cmds[n - 1])) {
+			messages[m++] = {&cmds[n], 1, false};
+		}
+		messages[m++] = {&data[2 * n], 2, true};
+		slots[n] = std::popcount(static_cast<uint8_t>(mask & ((1 << input) - 1)));
+		n++;
+	}
+	if (n == 0) {
+		return SUCCESS;
+	}
+
+	if (i2c.transfer({messages.data(), m}) != SUCCESS) {
+		lastCmd = NO_CMD;
 		return I2C_READ_FAILURE;
 	}
-	value = res * referenceVoltage / (1 << 12);
+	lastCmd = cmds[n - 1];
+	for (size_t i = 0; i < n; i++) {
+		Status s = parse(&data[2 * i], values[slots[i]]);
+		if (s != SUCCESS) {
+			return s;
+		}
+	}
 	return SUCCESS;
 }
 
-Status ADS7828::readChannelDifferentialPair(int pair, double& value) {
-    return readChannelDifferentialPair(pair, false, value);
-}
-
 Status ADS7828::setRunning(bool running) {
-	if (fd == -1) {
+	if (!i2c.is_open()) {
 		return I2C_SETUP_FAILURE;
 	}
 	uint8_t cmd = static_cast<uint8_t>((lastCmd & 0xf0) + (running * 0xc)); // overflow not possible due to math of expression
 	if (cmd != lastCmd) {
-		int res = wiringPiI2CWrite(fd, cmd);
-		if (res < 0) {
-			lastCmd = 255;
+		if (i2c.write({&cmd, 1}) != SUCCESS) {
+			lastCmd = NO_CMD;
 			return I2C_WRITE_FAILURE;
 		}
 		else {
@@ -144,4 +195,8 @@ Status ADS7828::setRunning(bool running) {
 
 double ADS7828::parseRawVoltage(uint16_t raw) {
     return raw * referenceVoltage / (1 << 12);
+}
+
+void ADS7828::parseRawVoltages(std::span<const uint16_t> raw, std::span<float> values) {
+	conversion::convert(raw, conversion::Linear{static_cast<float>(referenceVoltage / (1 << 12))}, values);
 }
\ No newline at end of file
@@ -2,12 +2,18 @@
 #define RAPID_CDH_ADS7828_H
 
 #include <cstdint>
+#include <span>
 
 #include "../globals.h"
+#include "I2CDevice.h"
 
 class ADS7828 {
 public:
-	ADS7828(const char* device, bool addr0, bool addr1, double referenceVoltage = 2.5);
+	// The internal reference, which the driver's commands keep on; compile-time conversion tables, as in PPG102A6 and
+	// TMP36, are built for it
+	static constexpr double DEFAULT_REFERENCE_VOLTAGE = 2.5;
+
+	ADS7828(const char* device, bool addr0, bool addr1, double referenceVoltage = DEFAULT_REFERENCE_VOLTAGE);
 	[[nodiscard]] Status init();
 	[[nodiscard]] Status readChannelCommonAnode(int channel, double& value);
 	[[nodiscard]] Status readChannelCommonAnodeRaw(int channel, uint16_t& value);
@@ -15,12 +21,25 @@ public:
     [[nodiscard]] Status readChannelDifferentialPair(int pair, double& value);
 	[[nodiscard]] Status readChannelDifferentialPairRaw(int pair, bool inverted, uint16_t& value);
 	[[nodiscard]] Status readChannelDifferentialPairRaw(int pair, uint16_t& value);
+	// Reads every channel set in mask (bit n is channel n) into values, lowest channel first, in one bus transaction.
+	// values must have room for one sample per set bit
+	[[nodiscard]] Status scanChannels(uint8_t mask, std::span<uint16_t> values);
+	// As scanChannels, for the differential pairs set in mask (bit n is pair n, see readChannelDifferentialPairRaw)
+	[[nodiscard]] Status scanDifferentialPairs(uint8_t mask, bool inverted, std::span<uint16_t> values);
 	[[nodiscard]] Status setRunning(bool running);
     double parseRawVoltage(uint16_t raw);
+	// parseRawVoltage over a buffer, into min(raw.size(), values.size()) values
+	void parseRawVoltages(std::span<const uint16_t> raw, std::span<float> values);
 private:
+	static constexpr uint8_t NO_CMD = 255; // Not a command the driver sends: the low two bits are unused
+
+	Status convert(uint8_t cmd, uint16_t& value);
+	static Status parse(const uint8_t* data, uint16_t& value);
+	Status scan(uint8_t mask, int count, uint8_t (*command)(int, bool), bool inverted, std::span<uint16_t> values);
+
 	double referenceVoltage;
-	int fd;
-	uint8_t lastCmd;
+	I2CDevice i2c;
+	uint8_t lastCmd = NO_CMD; // The command the device last accepted, so it is not sent again
 };
 
 #endif
\ No newline at end of file
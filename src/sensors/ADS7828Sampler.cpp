@@ -0,0 +1,169 @@
+#include "ADS7828Sampler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "ADS7828.h"
+#include "Gpio.h"
+
+namespace {
+    uint64_t pack(const ADS7828Sampler::Sample& sample) {
+        return sample.time_us << 16 | sample.raw;
+    }
+}
+
+ADS7828Sampler::Channel::Channel(const ChannelConfig& config)
+    : ring(config.capacity),
+      period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / config.rate_hz))),
+      excitation_pin(config.excitation_pin) {}
+
+ADS7828Sampler::ADS7828Sampler(ADS7828* adc, std::vector<ChannelConfig> channels)
+    : m_adc(adc), m_config(std::move(channels)) {}
+
+ADS7828Sampler::~ADS7828Sampler() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+Status ADS7828Sampler::init() {
+    if (m_thread.joinable()) {
+        return SUCCESS;
+    }
+    for (const ChannelConfig& config : m_config) {
+        if (config.channel < 0 || config.channel >= static_cast<int>(NUM_CHANNELS) || m_channels[config.channel] ||
+            !(config.rate_hz > 0)) {
+            m_channels = {};
+            return INVALID_INPUT;
+        }
+        m_channels[config.channel] = std::make_unique<Channel>(config);
+    }
+
+    Status status = m_adc->init();
+    if (status != SUCCESS) {
+        m_channels = {};
+        return status;
+    }
+
+    for (const std::unique_ptr<Channel>& channel : m_channels) {
+        if (channel && channel->excitation_pin >= 0) {
+            gpio::set_output(channel->excitation_pin);
+        }
+    }
+    m_thread = std::thread(&ADS7828Sampler::run, this);
+    return SUCCESS;
+}
+
+const ADS7828Sampler::Channel* ADS7828Sampler::find(int channel) const {
+    if (channel < 0 || channel >= static_cast<int>(NUM_CHANNELS)) {
+        return nullptr;
+    }
+    return m_channels[channel].get();
+}
+
+Status ADS7828Sampler::latest(int channel, Sample& sample) const {
+    const Channel* c = find(channel);
+    if (!c) {
+        return INVALID_INPUT;
+    }
+    uint64_t packed = c->latest.load(std::memory_order_acquire);
+    if (packed == 0) {
+        return FAILURE;
+    }
+    sample = {packed >> 16, static_cast<uint16_t>(packed)};
+    return SUCCESS;
+}
+
+size_t ADS7828Sampler::drain(int channel, std::span<Sample> samples) {
+    const Channel* c = find(channel);
+    return c ? m_channels[channel]->ring.pop(samples) : 0;
+}
+
+double ADS7828Sampler::voltage(uint16_t raw) const {
+    return m_adc->parseRawVoltage(raw);
+}
+
+uint64_t ADS7828Sampler::overruns(int channel) const {
+    const Channel* c = find(channel);
+    return c ? c->overruns.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t ADS7828Sampler::failures() const {
+    return m_failures.load(std::memory_order_relaxed);
+}
+
+void ADS7828Sampler::run() {
+    Clock::time_point start = Clock::now();
+    for (const std::unique_ptr<Channel>& channel : m_channels) {
+        if (channel) {
+            channel->next = start;
+        }
+    }
+
+    std::array<uint16_t, NUM_CHANNELS> raw{};
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        Clock::time_point now = Clock::now();
+        Clock::time_point wake = Clock::time_point::max();
+        uint8_t due = 0;
+        for (size_t i = 0; i < NUM_CHANNELS; i++) {
+            if (m_channels[i] && m_channels[i]->next <= now) {
+                due |= 1 << i;
+            } else if (m_channels[i]) {
+                wake = std::min(wake, m_channels[i]->next);
+            }
+        }
+        if (due == 0) {
+            if (wake == Clock::time_point::max()) {
+                m_wake.wait(lock, [this]() { return m_stopping; }); // No channels
+            } else {
+                m_wake.wait_until(lock, wake, [this]() { return m_stopping; });
+            }
+            continue;
+        }
+
+        lock.unlock();
+        for (size_t i = 0; i < NUM_CHANNELS; i++) {
+            if ((due >> i & 1) && m_channels[i]->excitation_pin >= 0) {
+                gpio::write(m_channels[i]->excitation_pin, true);
+            }
+        }
+        Status status = m_adc->scanChannels(due, raw);
+        for (size_t i = 0; i < NUM_CHANNELS; i++) {
+            if ((due >> i & 1) && m_channels[i]->excitation_pin >= 0) {
+                gpio::write(m_channels[i]->excitation_pin, false);
+            }
+        }
+
+        // scanChannels packs the samples of the due channels in channel order
+        uint64_t time_us = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+        size_t slot = 0;
+        for (size_t i = 0; i < NUM_CHANNELS; i++) {
+            if (!(due >> i & 1)) {
+                continue;
+            }
+            Channel& channel = *m_channels[i];
+            if (status == SUCCESS) {
+                Sample sample{time_us, raw[slot++]};
+                channel.latest.store(pack(sample), std::memory_order_release);
+                if (!channel.ring.try_push(sample)) {
+                    channel.overruns.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            // Keep to the channel's rate, but skip the slots missed if the thread fell behind rather than bursting
+            channel.next += channel.period;
+            if (channel.next <= now) {
+                channel.next = now + channel.period;
+            }
+        }
+        if (status != SUCCESS) {
+            m_failures.fetch_add(1, std::memory_order_relaxed);
+        }
+        lock.lock();
+    }
+}
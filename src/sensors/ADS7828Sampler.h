@@ -0,0 +1,96 @@
+#ifndef RAPIDCDH_ADS7828SAMPLER_H
+#define RAPIDCDH_ADS7828SAMPLER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "../globals.h"
+#include "SpscRing.h"
+
+class ADS7828;
+
+// Samples a set of ADS7828 channels at fixed rates on a thread of its own and publishes the raw results, so readers
+// never touch the I2C bus. Each channel keeps its latest sample, readable from any thread, and a ring of every sample
+// for one consumer to drain. Channels that fall due together are read in one scan.
+// While the sampler runs it is the only user of the ADC.
+class ADS7828Sampler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Sample {
+        uint64_t time_us; // Clock time the scan that read it started, in microseconds
+        uint16_t raw;
+    };
+
+    struct ChannelConfig {
+        int channel; // Common-anode input, 0-7
+        double rate_hz;
+        size_t capacity = 256; // Samples the ring holds before new ones are dropped
+        int excitation_pin = -1; // GPIO held high while the channel is read, e.g. for PPG102A6; -1 for none
+    };
+
+    ADS7828Sampler(ADS7828* adc, std::vector<ChannelConfig> channels);
+    // Stops sampling and joins the thread
+    ~ADS7828Sampler();
+
+    ADS7828Sampler(const ADS7828Sampler&) = delete;
+    ADS7828Sampler& operator=(const ADS7828Sampler&) = delete;
+
+    // Starts sampling. INVALID_INPUT if a channel is out of range, listed twice or has a rate that is not positive;
+    // otherwise the ADC's own init status
+    [[nodiscard]] Status init();
+
+    // Most recent sample of a channel. Any thread. INVALID_INPUT if the channel is not sampled, FAILURE if it has not
+    // been read yet
+    [[nodiscard]] Status latest(int channel, Sample& sample) const;
+    // Moves the channel's samples since the last drain into samples, oldest first, and returns how many. Only one
+    // thread may drain a given channel. 0 for a channel that is not sampled
+    size_t drain(int channel, std::span<Sample> samples);
+
+    // ADC reading in volts, as ADS7828::parseRawVoltage
+    [[nodiscard]] double voltage(uint16_t raw) const;
+
+    // Samples dropped because the channel's ring was full
+    [[nodiscard]] uint64_t overruns(int channel) const;
+    // Scans that failed on the bus; their samples are skipped
+    [[nodiscard]] uint64_t failures() const;
+
+private:
+    static constexpr size_t NUM_CHANNELS = 8;
+
+    struct Channel {
+        explicit Channel(const ChannelConfig& config);
+
+        SpscRing<Sample> ring;
+        std::atomic<uint64_t> latest{0}; // time_us << 16 | raw; 0 until the first sample
+        std::atomic<uint64_t> overruns{0};
+        Clock::duration period;
+        Clock::time_point next{};
+        int excitation_pin;
+    };
+
+    void run();
+    const Channel* find(int channel) const;
+
+    ADS7828* m_adc;
+    std::vector<ChannelConfig> m_config;
+    std::array<std::unique_ptr<Channel>, NUM_CHANNELS> m_channels;
+    std::atomic<uint64_t> m_failures{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake; // Signalled on shutdown
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+
+#endif //RAPIDCDH_ADS7828SAMPLER_H
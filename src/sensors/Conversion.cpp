@@ -0,0 +1,153 @@
+#include "Conversion.h"
+
+#include <algorithm>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    float widen(uint16_t raw, int shift, bool is_signed) {
+        return is_signed ? static_cast<float>(static_cast<int16_t>(raw) >> shift) : static_cast<float>(raw >> shift);
+    }
+
+    float apply(float code, const conversion::Linear& map) {
+        return code * map.scale + map.offset;
+    }
+
+    float apply(float code, const conversion::Reciprocal& map) {
+        return map.scale / code + map.offset;
+    }
+
+    bool is_signed(const conversion::Linear& map) {
+        return map.is_signed;
+    }
+
+    bool is_signed(const conversion::Reciprocal&) {
+        return false;
+    }
+
+#if defined(__ARM_NEON)
+    constexpr size_t STEP = 8;
+
+    float32x4_t apply(float32x4_t code, const conversion::Linear& map) {
+        return vmlaq_n_f32(vdupq_n_f32(map.offset), code, map.scale);
+    }
+
+    float32x4_t apply(float32x4_t code, const conversion::Reciprocal& map) {
+#if defined(__aarch64__)
+        float32x4_t quotient = vdivq_f32(vdupq_n_f32(map.scale), code);
+#else
+        // ARMv7 has no vector divide: refine the reciprocal estimate twice, to within a few ulp
+        float32x4_t recip = vrecpeq_f32(code);
+        recip = vmulq_f32(vrecpsq_f32(code, recip), recip);
+        recip = vmulq_f32(vrecpsq_f32(code, recip), recip);
+        float32x4_t quotient = vmulq_n_f32(recip, map.scale);
+#endif
+        return vaddq_f32(quotient, vdupq_n_f32(map.offset));
+    }
+
+    template <typename Map>
+    void step(const uint16_t* raw, const Map& map, float* out) {
+        uint16x8_t codes = vld1q_u16(raw);
+        int16x8_t shift = vdupq_n_s16(static_cast<int16_t>(-map.shift));
+        float32x4_t lo;
+        float32x4_t hi;
+        if (is_signed(map)) {
+            int16x8_t s = vshlq_s16(vreinterpretq_s16_u16(codes), shift);
+            lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+            hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+        } else {
+            uint16x8_t u = vshlq_u16(codes, shift);
+            lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(u)));
+            hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(u)));
+        }
+        vst1q_f32(out, apply(lo, map));
+        vst1q_f32(out + 4, apply(hi, map));
+    }
+#elif defined(__AVX2__)
+    constexpr size_t STEP = 8;
+
+    __m256 apply(__m256 code, const conversion::Linear& map) {
+#if defined(__FMA__)
+        return _mm256_fmadd_ps(code, _mm256_set1_ps(map.scale), _mm256_set1_ps(map.offset));
+#else
+        return _mm256_add_ps(_mm256_mul_ps(code, _mm256_set1_ps(map.scale)), _mm256_set1_ps(map.offset));
+#endif
+    }
+
+    __m256 apply(__m256 code, const conversion::Reciprocal& map) {
+        return _mm256_add_ps(_mm256_div_ps(_mm256_set1_ps(map.scale), code), _mm256_set1_ps(map.offset));
+    }
+
+    template <typename Map>
+    void step(const uint16_t* raw, const Map& map, float* out) {
+        __m128i codes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw));
+        __m128i shift = _mm_cvtsi32_si128(map.shift);
+        __m256i wide = is_signed(map) ? _mm256_cvtepi16_epi32(_mm_sra_epi16(codes, shift))
+                                      : _mm256_cvtepu16_epi32(_mm_srl_epi16(codes, shift));
+        _mm256_storeu_ps(out, apply(_mm256_cvtepi32_ps(wide), map));
+    }
+#elif defined(__SSE2__)
+    constexpr size_t STEP = 8;
+
+    __m128 apply(__m128 code, const conversion::Linear& map) {
+        return _mm_add_ps(_mm_mul_ps(code, _mm_set1_ps(map.scale)), _mm_set1_ps(map.offset));
+    }
+
+    __m128 apply(__m128 code, const conversion::Reciprocal& map) {
+        return _mm_add_ps(_mm_div_ps(_mm_set1_ps(map.scale), code), _mm_set1_ps(map.offset));
+    }
+
+    template <typename Map>
+    void step(const uint16_t* raw, const Map& map, float* out) {
+        __m128i codes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw));
+        __m128i shift = _mm_cvtsi32_si128(map.shift);
+        __m128i lo;
+        __m128i hi;
+        if (is_signed(map)) {
+            codes = _mm_sra_epi16(codes, shift);
+            // Each code lands in the top half of a 32-bit lane; the arithmetic shift sign-extends it down
+            lo = _mm_srai_epi32(_mm_unpacklo_epi16(codes, codes), 16);
+            hi = _mm_srai_epi32(_mm_unpackhi_epi16(codes, codes), 16);
+        } else {
+            codes = _mm_srl_epi16(codes, shift);
+            lo = _mm_unpacklo_epi16(codes, _mm_setzero_si128());
+            hi = _mm_unpackhi_epi16(codes, _mm_setzero_si128());
+        }
+        _mm_storeu_ps(out, apply(_mm_cvtepi32_ps(lo), map));
+        _mm_storeu_ps(out + 4, apply(_mm_cvtepi32_ps(hi), map));
+    }
+#else
+    constexpr size_t STEP = 1;
+
+    template <typename Map>
+    void step(const uint16_t* raw, const Map& map, float* out) {
+        *out = apply(widen(*raw, map.shift, is_signed(map)), map);
+    }
+#endif
+
+    template <typename Map>
+    void convert_all(std::span<const uint16_t> raw, const Map& map, std::span<float> out) {
+        size_t count = std::min(raw.size(), out.size());
+        size_t i = 0;
+        for (; i + STEP <= count; i += STEP) {
+            step(raw.data() + i, map, out.data() + i);
+        }
+        for (; i < count; i++) {
+            out[i] = apply(widen(raw[i], map.shift, is_signed(map)), map);
+        }
+    }
+}
+
+namespace conversion {
+    void convert(std::span<const uint16_t> raw, const Linear& map, std::span<float> out) {
+        convert_all(raw, map, out);
+    }
+
+    void convert(std::span<const uint16_t> raw, const Reciprocal& map, std::span<float> out) {
+        convert_all(raw, map, out);
+    }
+}
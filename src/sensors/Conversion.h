@@ -0,0 +1,34 @@
+#ifndef RAPIDCDH_CONVERSION_H
+#define RAPIDCDH_CONVERSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Batch conversion of raw sensor codes to engineering units, for telemetry buffers rather than single readings. The
+// drivers' batch parse functions build their maps from these. Kernels use NEON when the compiler targets ARM, and AVX2
+// or SSE2 on x86, eight or sixteen codes per step; anything else, and the tail of every buffer, runs a scalar loop.
+// Results are float: every code fits in its 24-bit mantissa, and half the width of double doubles the throughput.
+namespace conversion {
+    // value = (raw >> shift) * scale + offset
+    struct Linear {
+        float scale;
+        float offset = 0;
+        int shift = 0; // Drops status bits below the code, e.g. the INA219 bus voltage's low three
+        bool is_signed = false; // raw is two's complement; the shift is then arithmetic
+    };
+
+    // value = scale / (raw >> shift) + offset; a code of 0 gives infinity
+    struct Reciprocal {
+        float scale;
+        float offset = 0;
+        int shift = 0;
+    };
+
+    // Converts min(raw.size(), out.size()) codes
+    void convert(std::span<const uint16_t> raw, const Linear& map, std::span<float> out);
+    void convert(std::span<const uint16_t> raw, const Reciprocal& map, std::span<float> out);
+}
+
+
+#endif //RAPIDCDH_CONVERSION_H
@@ -0,0 +1,144 @@
+#include "EnergyAccumulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Doubled trapezoid area in uA-us (or uW-us) per uAh (or uWh)
+    constexpr int64_t DOUBLED_PER_UNIT_HOUR = 2 * 3600LL * 1000000;
+}
+
+void EnergyAccumulator::Integral::add(int64_t doubled_area) {
+    remainder += doubled_area;
+    int64_t carry = remainder / DOUBLED_PER_UNIT_HOUR;
+    whole += carry;
+    remainder -= carry * DOUBLED_PER_UNIT_HOUR;
+}
+
+// In thousandths of a unit-hour, i.e. mAh or mWh
+double EnergyAccumulator::Integral::difference(const Integral& earlier) const {
+    int64_t units = whole - earlier.whole;
+    int64_t rest = remainder - earlier.remainder;
+    return (units + static_cast<double>(rest) / DOUBLED_PER_UNIT_HOUR) / 1000;
+}
+
+EnergyAccumulator::EnergyAccumulator(size_t rails, uint64_t checkpoint_interval_us, size_t history,
+                                     uint64_t max_gap_us)
+    : m_checkpoint_interval_us(checkpoint_interval_us > 0 ? checkpoint_interval_us : 1),
+      m_max_gap_us(std::min(max_gap_us, MAX_GAP_US)), m_rails(rails) {
+    for (Rail& rail : m_rails) {
+        rail.checkpoints.resize(history > 0 ? history : 1);
+    }
+}
+
+Status EnergyAccumulator::add_sample(size_t rail_index, uint64_t time_us, double current_mA, double power_mW) {
+    if (rail_index >= m_rails.size()) {
+        return INVALID_INPUT;
+    }
+    // Also false for NaN
+    if (!(std::abs(current_mA) <= MAX_READING && std::abs(power_mW) <= MAX_READING)) {
+        return INVALID_INPUT;
+    }
+    int64_t current_uA = std::llround(current_mA * 1000);
+    int64_t power_uW = std::llround(power_mW * 1000);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Rail& rail = m_rails[rail_index];
+    if (!rail.started) {
+        rail.started = true;
+        rail.origin_us = time_us;
+        rail.now.time_us = time_us;
+        rail.last_current_uA = current_uA;
+        rail.last_power_uW = power_uW;
+        rail.checkpoints[0] = {0, rail.now};
+        rail.next_boundary = 1;
+        return SUCCESS;
+    }
+    if (time_us < rail.now.time_us) {
+        return INVALID_INPUT;
+    }
+
+    // Boundaries before this sample are checkpointed at the previous one, before this interval is added
+    uint64_t offset = time_us - rail.origin_us;
+    uint64_t before = (offset + m_checkpoint_interval_us - 1) / m_checkpoint_interval_us;
+    // After a long silence only the boundaries the ring can still hold are written; the rest would be overwritten
+    uint64_t history = rail.checkpoints.size();
+    if (before > rail.next_boundary && before - rail.next_boundary > history) {
+        rail.next_boundary = before - history;
+    }
+    for (; rail.next_boundary < before; rail.next_boundary++) {
+        rail.checkpoints[rail.next_boundary % rail.checkpoints.size()] = {rail.next_boundary, rail.now};
+    }
+
+    uint64_t dt = time_us - rail.now.time_us;
+    if (dt <= m_max_gap_us) {
+        rail.now.charge.add((rail.last_current_uA + current_uA) * static_cast<int64_t>(dt));
+        rail.now.energy.add((rail.last_power_uW + power_uW) * static_cast<int64_t>(dt));
+        rail.now.covered_us += dt;
+    }
+    rail.now.time_us = time_us;
+    rail.last_current_uA = current_uA;
+    rail.last_power_uW = power_uW;
+
+    // A sample right on a boundary is its checkpoint
+    if (offset % m_checkpoint_interval_us == 0 && offset / m_checkpoint_interval_us == rail.next_boundary) {
+        rail.checkpoints[rail.next_boundary % rail.checkpoints.size()] = {rail.next_boundary, rail.now};
+        rail.next_boundary++;
+    }
+    return SUCCESS;
+}
+
+Status EnergyAccumulator::total(size_t rail_index, Totals& totals) const {
+    if (rail_index >= m_rails.size()) {
+        return INVALID_INPUT;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Rail& rail = m_rails[rail_index];
+    if (!rail.started) {
+        return FAILURE;
+    }
+    Point start;
+    start.time_us = rail.origin_us;
+    totals = difference(start, rail.now);
+    return SUCCESS;
+}
+
+Status EnergyAccumulator::since(size_t rail_index, uint64_t time_us, Totals& totals) const {
+    if (rail_index >= m_rails.size()) {
+        return INVALID_INPUT;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Rail& rail = m_rails[rail_index];
+    if (!rail.started) {
+        return FAILURE;
+    }
+    if (time_us > rail.now.time_us) {
+        return INVALID_INPUT;
+    }
+    if (time_us <= rail.origin_us) {
+        time_us = rail.origin_us;
+    }
+
+    // The first boundary at or after time_us; if no sample has crossed it yet, the latest sample is the start
+    uint64_t offset = time_us - rail.origin_us;
+    uint64_t boundary = (offset + m_checkpoint_interval_us - 1) / m_checkpoint_interval_us;
+    if (boundary >= rail.next_boundary) {
+        totals = difference(rail.now, rail.now);
+        return SUCCESS;
+    }
+    const Checkpoint& checkpoint = rail.checkpoints[boundary % rail.checkpoints.size()];
+    if (checkpoint.boundary != boundary) {
+        return INVALID_INPUT; // Overwritten: older than the history
+    }
+    totals = difference(checkpoint.point, rail.now);
+    return SUCCESS;
+}
+
+size_t EnergyAccumulator::rails() const {
+    return m_rails.size();
+}
+
+EnergyAccumulator::Totals EnergyAccumulator::difference(const Point& from, const Point& to) {
+    return {to.charge.difference(from.charge), to.energy.difference(from.energy), from.time_us, to.time_us,
+            to.covered_us - from.covered_us};
+}
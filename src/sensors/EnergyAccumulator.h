@@ -0,0 +1,94 @@
+#ifndef RAPIDCDH_ENERGYACCUMULATOR_H
+#define RAPIDCDH_ENERGYACCUMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "../globals.h"
+
+// Integrates the current and power samples of a set of power rails into charge and energy, so the budget per
+// subsystem can be downlinked instead of the samples. Samples come from INA219::readNextSample or the INA260 getters,
+// converted to mA and mW, with monotonic timestamps such as INA219::Sample::time_us.
+//
+// Each interval between consecutive samples adds the trapezoid under it. Readings are quantized to 1 uA and 1 uW and
+// the areas summed exactly in integers, carried into whole uAh and uWh, so the totals never drift however long the
+// rail runs. An interval longer than max_gap_us is left out rather than bridged, and shows up as less coverage.
+//
+// Every checkpoint_interval_us the running totals are checkpointed into a ring, so "since T" is two lookups and a
+// subtraction. T resolves to the last sample at or before the first checkpoint boundary at or after it, so queries
+// are exact on boundaries and otherwise start up to one interval late; Totals says where they actually start.
+// Thread-safe: one thread can add samples while others query
+class EnergyAccumulator {
+public:
+    struct Totals {
+        double charge_mAh;
+        double energy_mWh;
+        uint64_t from_us;    // Time of the sample the totals start from
+        uint64_t to_us;      // Time of the latest sample
+        uint64_t covered_us; // Time within [from_us, to_us] that was integrated, less gaps
+    };
+
+    // Largest reading add_sample accepts, in mA or mW, and longest max_gap_us; together they keep the doubled area of
+    // one interval, (a + b) * dt in uA-us or uW-us, well inside int64
+    static constexpr double MAX_READING = 1e6;
+    static constexpr uint64_t MAX_GAP_US = 2000000000;
+
+    // max_gap_us above MAX_GAP_US is clamped to it
+    explicit EnergyAccumulator(size_t rails, uint64_t checkpoint_interval_us = 1000000, size_t history = 3600,
+                               uint64_t max_gap_us = 1000000);
+
+    // INVALID_INPUT if the rail does not exist, time_us is earlier than its previous sample, or a reading is not
+    // finite or exceeds MAX_READING in magnitude
+    [[nodiscard]] Status add_sample(size_t rail, uint64_t time_us, double current_mA, double power_mW);
+
+    // Since the rail's first sample. FAILURE if it has none yet
+    [[nodiscard]] Status total(size_t rail, Totals& totals) const;
+    // Since time_us; INVALID_INPUT if that is older than the checkpoint history reaches back or after the latest sample
+    [[nodiscard]] Status since(size_t rail, uint64_t time_us, Totals& totals) const;
+
+    [[nodiscard]] size_t rails() const;
+
+private:
+    // An exact running integral: whole units, plus a remainder in doubled (trapezoid) uA-us or uW-us
+    struct Integral {
+        int64_t whole = 0;
+        int64_t remainder = 0;
+
+        void add(int64_t doubled_area);
+        [[nodiscard]] double difference(const Integral& earlier) const;
+    };
+
+    struct Point {
+        uint64_t time_us = 0;
+        Integral charge;
+        Integral energy;
+        uint64_t covered_us = 0;
+    };
+
+    struct Checkpoint {
+        uint64_t boundary = UINT64_MAX; // Which boundary after the first sample this is; UINT64_MAX when unused
+        Point point;
+    };
+
+    struct Rail {
+        bool started = false;
+        uint64_t origin_us = 0;
+        int64_t last_current_uA = 0;
+        int64_t last_power_uW = 0;
+        uint64_t next_boundary = 0;
+        Point now;
+        std::vector<Checkpoint> checkpoints;
+    };
+
+    static Totals difference(const Point& from, const Point& to);
+
+    const uint64_t m_checkpoint_interval_us;
+    const uint64_t m_max_gap_us;
+    mutable std::mutex m_mutex;
+    std::vector<Rail> m_rails;
+};
+
+
+#endif //RAPIDCDH_ENERGYACCUMULATOR_H
@@ -0,0 +1,26 @@
+#ifndef RAPIDCDH_GPIO_H
+#define RAPIDCDH_GPIO_H
+
+#include <functional>
+
+#include "../globals.h"
+
+// The few GPIO operations the drivers use, so they build without wiringPi. The target build implements these with
+// wiringPi (GpioWiringPi.cpp); the simulation build records the levels instead (src/sim/SimGpio.cpp).
+// Pins are wiringPi pin numbers
+namespace gpio {
+    inline constexpr int PINS = 64;
+
+    // Makes pin a push-pull output with no pull resistor, driven low
+    void set_output(int pin);
+    void write(int pin, bool high);
+
+    // Makes pin an input with a pull-up, for open-drain alert lines, and calls handler on its own thread at each
+    // falling edge. nullptr stops the calls; once this returns, the old handler is not running and is never called again.
+    // Handlers must be short and must not call on_falling_edge. INVALID_INPUT for a pin out of range, FAILURE if the
+    // interrupt could not be set up
+    [[nodiscard]] Status on_falling_edge(int pin, std::function<void()> handler);
+}
+
+
+#endif //RAPIDCDH_GPIO_H
@@ -0,0 +1,59 @@
+#include "Gpio.h"
+
+#include <array>
+#include <mutex>
+#include <utility>
+#include <wiringPi.h>
+
+namespace {
+    std::mutex handlers_mutex;
+    std::array<std::function<void()>, gpio::PINS> handlers;
+    std::array<bool, gpio::PINS> registered{};
+
+    // wiringPiISR takes a bare function, so each pin gets one that looks up its handler. The handler runs under the
+    // lock so that once on_falling_edge replaces it, it is not running and never runs again
+    template <int Pin>
+    void dispatch() {
+        std::lock_guard<std::mutex> lock(handlers_mutex);
+        if (handlers[Pin]) {
+            handlers[Pin]();
+        }
+    }
+
+    template <int... Pins>
+    constexpr std::array<void (*)(), sizeof...(Pins)> make_dispatchers(std::integer_sequence<int, Pins...>) {
+        return {&dispatch<Pins>...};
+    }
+
+    constexpr auto dispatchers = make_dispatchers(std::make_integer_sequence<int, gpio::PINS>{});
+}
+
+namespace gpio {
+    void set_output(int pin) {
+        pinMode(pin, OUTPUT);
+        pullUpDnControl(pin, PUD_OFF);
+        digitalWrite(pin, LOW);
+    }
+
+    void write(int pin, bool high) {
+        digitalWrite(pin, high ? HIGH : LOW);
+    }
+
+    Status on_falling_edge(int pin, std::function<void()> handler) {
+        if (pin < 0 || pin >= PINS) {
+            return INVALID_INPUT;
+        }
+        std::lock_guard<std::mutex> lock(handlers_mutex);
+        handlers[pin] = std::move(handler);
+        // wiringPi cannot remove an interrupt, so it stays registered and a cleared handler is skipped
+        if (!registered[pin] && handlers[pin]) {
+            pinMode(pin, INPUT);
+            pullUpDnControl(pin, PUD_UP);
+            if (wiringPiISR(pin, INT_EDGE_FALLING, dispatchers[pin]) < 0) {
+                return FAILURE;
+            }
+            registered[pin] = true;
+        }
+        return SUCCESS;
+    }
+}
@@ -0,0 +1,32 @@
+#include "I2CBackend.h"
+
+#include <array>
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+I2CDevBackend::I2CDevBackend(const char* device) {
+    m_fd = open(device, O_RDWR | O_CLOEXEC);
+}
+
+I2CDevBackend::~I2CDevBackend() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+bool I2CDevBackend::is_open() const {
+    return m_fd >= 0;
+}
+
+bool I2CDevBackend::transfer(std::span<const Segment> segments) {
+    std::array<i2c_msg, MAX_SEGMENTS> msgs;
+    for (size_t i = 0; i < segments.size(); i++) {
+        const Segment& s = segments[i];
+        msgs[i] = {s.address, static_cast<uint16_t>(s.read ? I2C_M_RD : 0), s.len, s.data};
+    }
+    i2c_rdwr_ioctl_data data{msgs.data(), static_cast<uint32_t>(segments.size())};
+    return ioctl(m_fd, I2C_RDWR, &data) >= 0;
+}
@@ -0,0 +1,47 @@
+#ifndef RAPIDCDH_I2CBACKEND_H
+#define RAPIDCDH_I2CBACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// What an I2CBus drives: the kernel's i2c-dev driver on the board, or a simulated bus (see src/sim) anywhere else.
+// Calls come from one thread at a time.
+class I2CBackend {
+public:
+    struct Segment {
+        uint8_t address;
+        uint8_t* data; // Only read from for writes
+        uint16_t len;
+        bool read;
+    };
+
+    // The most segments in one transfer, as the kernel's I2C_RDWR_IOCTL_MAX_MSGS
+    static constexpr size_t MAX_SEGMENTS = 42;
+
+    virtual ~I2CBackend() = default;
+
+    [[nodiscard]] virtual bool is_open() const = 0;
+    // Runs up to MAX_SEGMENTS segments as one transaction, with a repeated start before each after the first.
+    // Returns false if it failed, e.g. on a NACK, in which case earlier segments may already have gone out
+    [[nodiscard]] virtual bool transfer(std::span<const Segment> segments) = 0;
+};
+
+// A /dev/i2c-N bus, through ioctl(I2C_RDWR)
+class I2CDevBackend : public I2CBackend {
+public:
+    explicit I2CDevBackend(const char* device);
+    ~I2CDevBackend() override;
+
+    I2CDevBackend(const I2CDevBackend&) = delete;
+    I2CDevBackend& operator=(const I2CDevBackend&) = delete;
+
+    [[nodiscard]] bool is_open() const override;
+    [[nodiscard]] bool transfer(std::span<const Segment> segments) override;
+
+private:
+    int m_fd;
+};
+
+
+#endif //RAPIDCDH_I2CBACKEND_H
@@ -0,0 +1,208 @@
+#include "I2CBus.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <string>
+
+namespace {
+    bool reads(std::span<const I2CBus::Message> messages) {
+        return std::any_of(messages.begin(), messages.end(), [](const I2CBus::Message& m) { return m.read; });
+    }
+}
+
+I2CBus::I2CBus(const char* device) : I2CBus(std::make_unique<I2CDevBackend>(device)) {}
+
+I2CBus::I2CBus(std::unique_ptr<I2CBackend> backend) : m_backend(std::move(backend)) {
+    if (m_backend->is_open()) {
+        m_thread = std::thread(&I2CBus::work, this);
+    }
+}
+
+I2CBus::~I2CBus() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work_available.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+I2CBus::Batch::Batch(I2CBus& bus) : m_bus(bus) {
+    std::lock_guard<std::mutex> lock(m_bus.m_mutex);
+    m_bus.m_held++;
+}
+
+I2CBus::Batch::~Batch() {
+    {
+        std::lock_guard<std::mutex> lock(m_bus.m_mutex);
+        m_bus.m_held--;
+    }
+    m_bus.m_work_available.notify_one();
+}
+
+std::shared_ptr<I2CBus> I2CBus::open(const char* device) {
+    return registry(device, nullptr);
+}
+
+std::shared_ptr<I2CBus> I2CBus::attach(const char* device, std::unique_ptr<I2CBackend> backend) {
+    return registry(device, std::move(backend));
+}
+
+// Looks up the bus for device, creating an i2c-dev one if there is none. With a backend, replaces it instead
+std::shared_ptr<I2CBus> I2CBus::registry(const char* device, std::unique_ptr<I2CBackend> backend) {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<I2CBus>> buses;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::weak_ptr<I2CBus>& entry = buses[device];
+    std::shared_ptr<I2CBus> bus = backend ? nullptr : entry.lock();
+    if (!bus) {
+        bus = backend ? std::make_shared<I2CBus>(std::move(backend)) : std::make_shared<I2CBus>(device);
+        entry = bus;
+    }
+    return bus;
+}
+
+Status I2CBus::init() const {
+    return is_open() ? SUCCESS : I2C_SETUP_FAILURE;
+}
+
+bool I2CBus::is_open() const {
+    return m_backend->is_open();
+}
+
+void I2CBus::submit(uint8_t address, std::span<const Message> messages, Completion on_complete) {
+    if (!is_open()) {
+        on_complete(I2C_SETUP_FAILURE);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back({address, messages, std::move(on_complete)});
+    }
+    m_work_available.notify_one();
+}
+
+std::future<Status> I2CBus::submit(uint8_t address, std::span<const Message> messages) {
+    auto promise = std::make_shared<std::promise<Status>>();
+    std::future<Status> future = promise->get_future();
+    submit(address, messages, [promise](Status status) { promise->set_value(status); });
+    return future;
+}
+
+Status I2CBus::transfer(uint8_t address, std::span<const Message> messages) {
+    if (!is_open()) {
+        return I2C_SETUP_FAILURE;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_busy || m_held > 0 || !m_queue.empty()) {
+        lock.unlock();
+        return submit(address, messages).get();
+    }
+
+    // The bus is idle: run here rather than wake the bus thread and wait for it
+    m_busy = true;
+    lock.unlock();
+    Transaction transaction{address, messages, nullptr};
+    Status status = run({&transaction, 1});
+    lock.lock();
+    m_busy = false;
+    bool queued = !m_queue.empty();
+    lock.unlock();
+    if (queued) {
+        m_work_available.notify_one();
+    }
+    return status;
+}
+
+uint64_t I2CBus::ioctls() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ioctls;
+}
+
+uint64_t I2CBus::merged() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_merged;
+}
+
+// Sends the batch's messages in as few ioctls as possible. A batch of several transactions always fits in one
+Status I2CBus::run(std::span<const Transaction> batch) {
+    std::array<I2CBackend::Segment, MAX_MESSAGES> segments;
+    size_t count = 0;
+    uint64_t ioctls = 0;
+    Status status = SUCCESS;
+
+    auto flush = [&]() {
+        ioctls++;
+        bool ok = m_backend->transfer(std::span<const I2CBackend::Segment>(segments.data(), count));
+        count = 0;
+        return ok;
+    };
+
+    for (const Transaction& transaction : batch) {
+        std::span<const Message> messages = transaction.messages;
+        for (size_t i = 0; i < messages.size(); i++) {
+            // Only a single long transaction gets here; keep a write and the read after it together
+            bool split_pair = count == MAX_MESSAGES - 1 && !messages[i].read && i + 1 < messages.size() &&
+                              messages[i + 1].read;
+            if ((count == MAX_MESSAGES || split_pair) && !flush()) {
+                status = FAILURE;
+                break;
+            }
+            const Message& m = messages[i];
+            segments[count++] = {transaction.address, m.data, m.len, m.read};
+        }
+    }
+    if (status == SUCCESS && count > 0 && !flush()) {
+        status = FAILURE;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ioctls += ioctls;
+    }
+    if (status == SUCCESS) {
+        return SUCCESS;
+    }
+    return reads(batch.front().messages) ? I2C_READ_FAILURE : I2C_WRITE_FAILURE;
+}
+
+void I2CBus::work() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_work_available.wait(lock, [this]() {
+            return !m_busy && m_held == 0 && (m_stopping || !m_queue.empty());
+        });
+        if (m_queue.empty()) {
+            return; // Stopping, and everything queued has run
+        }
+
+        // Take transactions, oldest first, while their messages still fit in one ioctl
+        size_t messages = 0;
+        m_batch.clear();
+        while (!m_queue.empty() &&
+               (m_batch.empty() || messages + m_queue.front().messages.size() <= MAX_MESSAGES)) {
+            messages += m_queue.front().messages.size();
+            m_batch.push_back(std::move(m_queue.front()));
+            m_queue.pop_front();
+        }
+        if (m_batch.size() > 1) {
+            m_merged += m_batch.size();
+        }
+        m_busy = true;
+        lock.unlock();
+
+        Status status = run(m_batch);
+        for (Transaction& transaction : m_batch) {
+            // Retry alone so that only the device at fault sees the failure
+            transaction.on_complete(status == SUCCESS || m_batch.size() == 1 ? status : run({&transaction, 1}));
+        }
+
+        lock.lock();
+        m_busy = false;
+    }
+}
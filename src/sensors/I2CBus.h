@@ -0,0 +1,115 @@
+#ifndef RAPIDCDH_I2CBUS_H
+#define RAPIDCDH_I2CBUS_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "../globals.h"
+#include "I2CBackend.h"
+
+// Sole owner of one I2C bus, normally a Linux i2c-dev bus. Transactions can come from any thread: they are queued and
+// run in submission order by the bus's own thread, so one device's pointer write and read are never split by another
+// thread's traffic.
+// Queued transactions are merged into one transfer (one ioctl(I2C_RDWR)), up to MAX_MESSAGES messages, so a backlog
+// drains in fewer syscalls and bus turnarounds. When nothing is queued, a blocking transfer runs on the calling thread
+// without the hand-off.
+//
+// If a merged transfer fails, each of its transactions is run again on its own so the failure lands only on the device
+// that caused it. Messages before the failure may therefore go out twice; register reads, pointer writes and
+// configuration writes, which is all the sensor drivers send, are safe to repeat.
+class I2CBus {
+public:
+    struct Message {
+        uint8_t* data; // Only read from for writes
+        uint16_t len;
+        bool read;
+    };
+
+    // Called once per transaction with its status, on the bus thread. It may submit more but must not call transfer
+    using Completion = std::function<void(Status)>;
+
+    // Holds the queue back from the bus thread while it lives, so transactions submitted meanwhile, e.g. reads of
+    // several devices, go out together in as few transfers as fit them. The holding thread must not call transfer
+    class Batch {
+    public:
+        explicit Batch(I2CBus& bus);
+        ~Batch();
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+    private:
+        I2CBus& m_bus;
+    };
+
+    // The most messages the kernel takes in one ioctl (I2C_RDWR_IOCTL_MAX_MSGS)
+    static constexpr size_t MAX_MESSAGES = I2CBackend::MAX_SEGMENTS;
+
+    // The i2c-dev bus at device
+    explicit I2CBus(const char* device);
+    explicit I2CBus(std::unique_ptr<I2CBackend> backend);
+    // Finishes the queued transactions and joins the bus thread
+    ~I2CBus();
+
+    I2CBus(const I2CBus&) = delete;
+    I2CBus& operator=(const I2CBus&) = delete;
+
+    // The bus for device, shared by everything that opens it while any user holds it
+    static std::shared_ptr<I2CBus> open(const char* device);
+    // Makes open(device) return a bus driven by backend, e.g. a simulation, for as long as the returned bus is held.
+    // Drivers constructed with that device path then use it unchanged
+    static std::shared_ptr<I2CBus> attach(const char* device, std::unique_ptr<I2CBackend> backend);
+
+    // I2C_SETUP_FAILURE if the bus could not be opened
+    [[nodiscard]] Status init() const;
+    [[nodiscard]] bool is_open() const;
+
+    // Queues messages for the device at address. The messages and their buffers must stay valid until on_complete
+    // is called. A transaction longer than MAX_MESSAGES is split between ioctls, never between a write and the read
+    // after it. I2C_READ_FAILURE if any message reads and the transaction fails, I2C_WRITE_FAILURE if it only writes
+    void submit(uint8_t address, std::span<const Message> messages, Completion on_complete);
+    [[nodiscard]] std::future<Status> submit(uint8_t address, std::span<const Message> messages);
+    // Runs the messages and waits for them
+    [[nodiscard]] Status transfer(uint8_t address, std::span<const Message> messages);
+
+    // Transfers (ioctls) issued, and transactions that shared one with another
+    [[nodiscard]] uint64_t ioctls() const;
+    [[nodiscard]] uint64_t merged() const;
+
+private:
+    struct Transaction {
+        uint8_t address;
+        std::span<const Message> messages;
+        Completion on_complete;
+    };
+
+    Status run(std::span<const Transaction> batch);
+    void work();
+
+    static std::shared_ptr<I2CBus> registry(const char* device, std::unique_ptr<I2CBackend> backend);
+
+    std::unique_ptr<I2CBackend> m_backend;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_work_available;
+    std::deque<Transaction> m_queue;
+    bool m_busy = false; // A batch is on the bus, from the bus thread or inline
+    int m_held = 0; // Live Batch guards
+    bool m_stopping = false;
+    uint64_t m_ioctls = 0;
+    uint64_t m_merged = 0;
+    std::vector<Transaction> m_batch; // Bus thread only
+    std::thread m_thread;
+};
+
+
+#endif //RAPIDCDH_I2CBUS_H
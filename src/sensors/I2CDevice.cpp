@@ -0,0 +1,81 @@
+#include "I2CDevice.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+I2CDevice::I2CDevice(const char* device, uint8_t address) : I2CDevice(I2CBus::open(device), address) {}
+
+I2CDevice::I2CDevice(std::shared_ptr<I2CBus> bus, uint8_t address) : m_bus(std::move(bus)), m_address(address) {}
+
+Status I2CDevice::init() const {
+    return m_bus->init();
+}
+
+bool I2CDevice::is_open() const {
+    return m_bus->is_open();
+}
+
+Status I2CDevice::transfer(std::span<const Message> messages) {
+    return m_bus->transfer(m_address, messages);
+}
+
+std::future<Status> I2CDevice::submit(std::span<const Message> messages) {
+    return m_bus->submit(m_address, messages);
+}
+
+Status I2CDevice::write(std::span<const uint8_t> data) {
+    Message message{const_cast<uint8_t*>(data.data()), static_cast<uint16_t>(data.size()), false};
+    return transfer({&message, 1});
+}
+
+Status I2CDevice::read(std::span<uint8_t> data) {
+    Message message{data.data(), static_cast<uint16_t>(data.size()), true};
+    return transfer({&message, 1});
+}
+
+Status I2CDevice::write_read(std::span<const uint8_t> out, std::span<uint8_t> in) {
+    std::array<Message, 2> messages{{
+        {const_cast<uint8_t*>(out.data()), static_cast<uint16_t>(out.size()), false},
+        {in.data(), static_cast<uint16_t>(in.size()), true},
+    }};
+    return transfer(messages);
+}
+
+Status I2CDevice::read_reg16(uint8_t reg, uint16_t& value) {
+    return read_regs16({&reg, 1}, {&value, 1});
+}
+
+Status I2CDevice::write_reg16(uint8_t reg, uint16_t value) {
+    std::array<uint8_t, 3> data{reg, static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+    return write(data);
+}
+
+Status I2CDevice::read_regs16(std::span<const uint8_t> regs, std::span<uint16_t> values) {
+    constexpr size_t PER_IOCTL = MAX_MESSAGES / 2;
+    size_t count = std::min(regs.size(), values.size());
+    std::array<uint8_t, PER_IOCTL> pointers;
+    std::array<uint8_t, PER_IOCTL * 2> data;
+    std::array<Message, PER_IOCTL * 2> messages;
+
+    for (size_t start = 0; start < count; start += PER_IOCTL) {
+        size_t n = std::min(count - start, PER_IOCTL);
+        for (size_t i = 0; i < n; i++) {
+            pointers[i] = regs[start + i];
+            messages[2 * i] = {&pointers[i], 1, false};
+            messages[2 * i + 1] = {&data[2 * i], 2, true};
+        }
+        Status status = transfer({messages.data(), 2 * n});
+        if (status != SUCCESS) {
+            return status;
+        }
+        for (size_t i = 0; i < n; i++) {
+            values[start + i] = static_cast<uint16_t>(data[2 * i] << 8 | data[2 * i + 1]);
+        }
+    }
+    return SUCCESS;
+}
+
+I2CBus& I2CDevice::bus() const {
+    return *m_bus;
+}
@@ -0,0 +1,54 @@
+#ifndef RAPIDCDH_I2CDEVICE_H
+#define RAPIDCDH_I2CDEVICE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <span>
+
+#include "../globals.h"
+#include "I2CBus.h"
+
+// One device on an I2C bus. Every device on the same bus device file shares its I2CBus, so drivers on different
+// threads never interleave their transactions. All the messages of a transfer go out as a single bus transaction,
+// joined by repeated starts, in a single syscall: a register-pointer or command write and the read after it cost one
+// transaction rather than two, and reads of several registers can share one ioctl.
+class I2CDevice {
+public:
+    using Message = I2CBus::Message;
+
+    static constexpr size_t MAX_MESSAGES = I2CBus::MAX_MESSAGES;
+
+    I2CDevice(const char* device, uint8_t address);
+    I2CDevice(std::shared_ptr<I2CBus> bus, uint8_t address);
+
+    // I2C_SETUP_FAILURE if the bus could not be opened
+    [[nodiscard]] Status init() const;
+    [[nodiscard]] bool is_open() const;
+
+    // Sends messages in order and waits for them; see I2CBus::transfer
+    [[nodiscard]] Status transfer(std::span<const Message> messages);
+    // Queues messages without waiting; see I2CBus::submit. The messages and their buffers must outlive the future
+    [[nodiscard]] std::future<Status> submit(std::span<const Message> messages);
+
+    [[nodiscard]] Status write(std::span<const uint8_t> data);
+    [[nodiscard]] Status read(std::span<uint8_t> data);
+    // Writes out and reads into in, with a repeated start between them
+    [[nodiscard]] Status write_read(std::span<const uint8_t> out, std::span<uint8_t> in);
+
+    // 16-bit registers behind an 8-bit pointer, sent MSB first as on the ADS7828, INA219 and INA260
+    [[nodiscard]] Status read_reg16(uint8_t reg, uint16_t& value);
+    [[nodiscard]] Status write_reg16(uint8_t reg, uint16_t value);
+    // Reads regs[i] into values[i] for min(regs.size(), values.size()) registers, in one ioctl for up to 21
+    [[nodiscard]] Status read_regs16(std::span<const uint8_t> regs, std::span<uint16_t> values);
+
+    [[nodiscard]] I2CBus& bus() const;
+
+private:
+    std::shared_ptr<I2CBus> m_bus;
+    uint8_t m_address;
+};
+
+
+#endif //RAPIDCDH_I2CDEVICE_H
@@ -1,17 +1,26 @@
 #include "INA219.h"
 
-#include <wiringPi.h>
-#include <wiringPiI2C.h>
+#include <algorithm>
+#include <array>
+#include <thread>
 
 #include "../globals.h"
+#include "Conversion.h"
 
-int configInt(INA219::ShuntVoltageRangeSetting v, int os, bool fr, bool on) {
+namespace {
+    constexpr uint16_t CNVR = 1 << 1;
+    constexpr uint16_t OVF = 1 << 0;
+    // Reads a consistent getSnapshot may make to get a result from one conversion
+    constexpr int CONSISTENT_SNAPSHOT_ATTEMPTS = 3;
+}
+
+int configInt(INA219::ShuntVoltageRangeSetting v, int os, bool fr, INA219::Mode mode) {
     int out = 0; // reset bit 15 = 0, unused bit 14 = 0
     out += fr << 13; // set bit 13 to zero iff the full voltage range of the ina219 is desired
     out += v << 11; // sets bits 11 and 12 to the appropriate values for the selected PGA gain/range
     out += (os > 0 ? (os + 8) : (os + 3)) << 7; // sets bits 7-10 to set the bus ADC to the desired oversampling level
     out += (os > 0 ? (os + 8) : (os + 3)) << 3; // sets bits 3-6 to set the shunt ADC to the desired oversampling level
-    out += 0b111 * on; // sets bits 0-2 to set the ADC to continuously on mode or fully off mode
+    out += mode; // sets bits 0-2 to the ADC mode: continuous, triggered or off
     return out;
 }
 
@@ -36,39 +45,41 @@ int calibInt(double shuntResistance, INA219::ShuntVoltageRangeSetting vsetting,
         break;
     }
     double maxCurrent = maxV / shuntResistance;
-    Ilsb = maxCurrent / (1 << 15);
+    double lsb = maxCurrent / (1 << 15);
+    // The LSBs are kept in mA and mW, the units the readings are returned in
+    Ilsb = 1000 * lsb;
     Plsb = 20 * Ilsb;
-    return static_cast<int>(0.04096 / (Ilsb * shuntResistance));
+    return static_cast<int>(0.04096 / (lsb * shuntResistance));
 }
 
 INA219::INA219(
         const char* device, AddrSelect addr0, AddrSelect addr1, double shuntResistance,
         ShuntVoltageRangeSetting v, int oversampling, bool busVoltageFullRange
-) {
+) : i2c(device, static_cast<uint8_t>(0b1000000 + addr0 + 4 * addr1)) {
     this->voltageRangeSetting = v;
     this->busVoltageFullRange = busVoltageFullRange;
     this->oversampling = oversampling;
     this->shuntResistance = shuntResistance;
     this->running = true;
-    fd = wiringPiI2CSetupInterface(device, 0b1000000 + addr0 + 4 * addr1);
-    if (fd < 0) {
+    if (!i2c.is_open()) {
         ctrRes = I2C_SETUP_FAILURE;
         return;
     }
-    lastConfigInt = configInt(v, oversampling, busVoltageFullRange, true);
-    int confStatus = wiringPiI2CWriteReg16(fd, CONFIGURATION, lastConfigInt);
+    lastConfigInt = configInt(v, oversampling, busVoltageFullRange, Continuous);
+    Status confStatus = i2c.write_reg16(CONFIGURATION, lastConfigInt);
     lastCalibInt = calibInt(shuntResistance, v, currentLSB, powerLSB);
-    int calStatus = wiringPiI2CWriteReg16(fd, CALIBRATION, lastCalibInt);
-    if (confStatus < 0 || calStatus < 0) {
-        if (calStatus < 0) {
+    Status calStatus = i2c.write_reg16(CALIBRATION, lastCalibInt);
+    if (confStatus != SUCCESS || calStatus != SUCCESS) {
+        if (calStatus != SUCCESS) {
             lastCalibInt = -1;
             currentLSB = -1;
             powerLSB = -1;
         }
-        if (confStatus < 0) {
+        if (confStatus != SUCCESS) {
             lastConfigInt = -1;
         }
         ctrRes = I2C_WRITE_FAILURE;
+        return;
     }
     ctrRes = SUCCESS;
 }
@@ -78,11 +89,11 @@ Status INA219::init() {
 }
 
 Status INA219::getShuntVoltage_mV(double& value) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
-    int res = wiringPiI2CReadReg16(fd, SHUNT_VOLTAGE);
-    if (res < 0) {
+    uint16_t res;
+    if (i2c.read_reg16(SHUNT_VOLTAGE, res) != SUCCESS) {
         return I2C_READ_FAILURE;
     }
     value = *((int16_t*) &res) / 100.0; // data processing casts
@@ -90,14 +101,14 @@ Status INA219::getShuntVoltage_mV(double& value) {
 }
 
 Status INA219::getShuntVoltageRaw(uint16_t& value) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
-    int res = wiringPiI2CReadReg16(fd, SHUNT_VOLTAGE);
-    if (res < 0) {
+    uint16_t res;
+    if (i2c.read_reg16(SHUNT_VOLTAGE, res) != SUCCESS) {
         return I2C_READ_FAILURE;
     }
-    value = static_cast<uint16_t>(res); // overflow not possible, value obtained from function that reads from a two-byte register
+    value = res;
     return SUCCESS;
 }
 
@@ -105,27 +116,30 @@ double INA219::parseShuntVoltage_mV(uint16_t raw) {
     return *((int16_t*) &raw) / 100.0; // data processing casts
 }
 
+void INA219::parseShuntVoltages_mV(std::span<const uint16_t> raw, std::span<float> values) {
+    conversion::convert(raw, conversion::Linear{.scale = 0.01f, .is_signed = true}, values);
+}
+
 Status INA219::getSupplyVoltage_mV(double& value) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
-    double bus = 0;
-    double shunt = 0;
-    Status s1 = getBusVoltage_mV(bus);
-    Status s2 = getShuntVoltage_mV(shunt);
-    if (s1 == I2C_READ_FAILURE || s2 == I2C_READ_FAILURE) {
+    // Both registers in one transaction, so they are read as close together as the bus allows
+    std::array<uint8_t, 2> regs{BUS_VOLTAGE, SHUNT_VOLTAGE};
+    std::array<uint16_t, 2> raw;
+    if (i2c.read_regs16(regs, raw) != SUCCESS) {
         return I2C_READ_FAILURE;
     }
-    value = bus + shunt;
+    value = parseBusVoltage_mV(raw[0]) + parseShuntVoltage_mV(raw[1]);
     return SUCCESS;
 }
 
 Status INA219::getBusVoltage_mV(double& value) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
-    int res = wiringPiI2CReadReg16(fd, BUS_VOLTAGE);
-    if (res < 0) {
+    uint16_t res;
+    if (i2c.read_reg16(BUS_VOLTAGE, res) != SUCCESS) {
         return I2C_READ_FAILURE;
     }
     value = 4.0 * (res >> 3);
@@ -133,14 +147,14 @@ Status INA219::getBusVoltage_mV(double& value) {
 }
 
 Status INA219::getBusVoltageRaw(uint16_t& value) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
-    int res = wiringPiI2CReadReg16(fd, BUS_VOLTAGE);
-    if (res < 0) {
+    uint16_t res;
+    if (i2c.read_reg16(BUS_VOLTAGE, res) != SUCCESS) {
         return I2C_READ_FAILURE;
     }
-    value = static_cast<uint16_t>(res); // overflow not possible, value obtained from function that reads from a two-byte register
+    value = res;
     return SUCCESS;
 }
 
@@ -148,23 +162,31 @@ double INA219::parseBusVoltage_mV(uint16_t raw) {
     return 4.0 * (raw >> 3);
 }
 
-Status validateData(int fd) {
-    int res = wiringPiI2CReadReg16(fd, INA219::BUS_VOLTAGE);
-    return res < 0 ? I2C_READ_FAILURE : res & 1 ? I2C_BAD_DATA : SUCCESS;
+void INA219::parseBusVoltages_mV(std::span<const uint16_t> raw, std::span<float> values) {
+    conversion::convert(raw, conversion::Linear{.scale = 4.0f, .shift = 3}, values);
+}
+
+// Reads reg together with the bus voltage register, whose low bit flags an overflow in the current and power
+// calculations, in one transaction
+Status INA219::readValidated(Registers reg, uint16_t& value) {
+    std::array<uint8_t, 2> regs{static_cast<uint8_t>(reg), BUS_VOLTAGE};
+    std::array<uint16_t, 2> values;
+    if (i2c.read_regs16(regs, values) != SUCCESS) {
+        return I2C_READ_FAILURE;
+    }
+    value = values[0];
+    return values[1] & OVF ? I2C_BAD_DATA : SUCCESS;
 }
 
 Status INA219::getCurrent_mA(double& value) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
     if (currentLSB < 0) {
         return I2C_PRIOR_WRITE_FAILURE;
     }
-    int res = wiringPiI2CReadReg16(fd, CURRENT);
-    if (res < 0) {
-        return I2C_READ_FAILURE;
-    }
-    Status valid = validateData(fd);
+    uint16_t res;
+    Status valid = readValidated(CURRENT, res);
     if (valid != SUCCESS) {
         return valid;
     }
@@ -173,21 +195,18 @@ Status INA219::getCurrent_mA(double& value) {
 }
 
 Status INA219::getCurrentRaw(uint16_t& value) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
     if (currentLSB < 0) {
         return I2C_PRIOR_WRITE_FAILURE;
     }
-    int res = wiringPiI2CReadReg16(fd, CURRENT);
-    if (res < 0) {
-        return I2C_READ_FAILURE;
-    }
-    Status valid = validateData(fd);
+    uint16_t res;
+    Status valid = readValidated(CURRENT, res);
     if (valid != SUCCESS) {
         return valid;
     }
-    value = static_cast<uint16_t>(res); // overflow not possible, value obtained from function that reads from a two-byte register
+    value = res;
     return SUCCESS;
 }
 
@@ -195,36 +214,29 @@ double INA219::parseCurrent_mA(uint16_t raw) {
     return *((int16_t*) &raw) * currentLSB; // data processing casts
 }
 
+void INA219::parseCurrents_mA(std::span<const uint16_t> raw, std::span<float> values) {
+    conversion::convert(raw, conversion::Linear{.scale = static_cast<float>(currentLSB), .is_signed = true}, values);
+}
+
 Status INA219::getSupplyPower_mW(double& value) {
-    if (fd == -1) {
-        return I2C_SETUP_FAILURE;
-    }
-    double voltage = 0;
-    double current = 0;
-    Status s1 = getSupplyVoltage_mV(voltage);
-    Status s2 = getCurrent_mA(current);
-    if (s2 == I2C_PRIOR_WRITE_FAILURE) {
-        return I2C_PRIOR_WRITE_FAILURE;
+    Snapshot snapshot;
+    Status status = getSnapshot(snapshot);
+    if (status != SUCCESS) {
+        return status;
     }
-    if (s1 == I2C_READ_FAILURE || s2 == I2C_READ_FAILURE) {
-        return I2C_READ_FAILURE;
-    }
-    value = voltage * current / 1000;
+    value = snapshot.supplyPower_mW;
     return SUCCESS;
 }
 
 Status INA219::getBusPower_mW(double& value) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
     if (powerLSB < 0) {
         return I2C_PRIOR_WRITE_FAILURE;
     }
-    int res = wiringPiI2CReadReg16(fd, POWER);
-    if (res < 0) {
-        return I2C_READ_FAILURE;
-    }
-    Status valid = validateData(fd);
+    uint16_t res;
+    Status valid = readValidated(POWER, res);
     if (valid != SUCCESS) {
         return valid;
     }
@@ -233,21 +245,18 @@ Status INA219::getBusPower_mW(double& value) {
 }
 
 Status INA219::getBusPowerRaw(uint16_t& value) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
     if (powerLSB < 0) {
         return I2C_PRIOR_WRITE_FAILURE;
     }
-    int res = wiringPiI2CReadReg16(fd, POWER);
-    if (res < 0) {
-        return I2C_READ_FAILURE;
-    }
-    Status valid = validateData(fd);
+    uint16_t res;
+    Status valid = readValidated(POWER, res);
     if (valid != SUCCESS) {
         return valid;
     }
-    value = static_cast<uint16_t>(res); // overflow not possible, value obtained from function that reads from a two-byte register
+    value = res;
     return SUCCESS;
 }
 
@@ -255,8 +264,41 @@ double INA219::parseBusPower_mW(uint16_t raw) {
     return raw * powerLSB;
 }
 
+void INA219::parseBusPowers_mW(std::span<const uint16_t> raw, std::span<float> values) {
+    conversion::convert(raw, conversion::Linear{static_cast<float>(powerLSB)}, values);
+}
+
+Status INA219::getSnapshot(Snapshot& snapshot, bool consistent) {
+    if (!i2c.is_open()) {
+        return I2C_SETUP_FAILURE;
+    }
+    if (currentLSB < 0) {
+        return I2C_PRIOR_WRITE_FAILURE;
+    }
+    std::array<uint8_t, 4> regs{POWER, CURRENT, SHUNT_VOLTAGE, BUS_VOLTAGE};
+    std::array<uint16_t, 4> values;
+    int attempts = consistent ? CONSISTENT_SNAPSHOT_ATTEMPTS : 1;
+    for (int attempt = 0; attempt < attempts; attempt++) {
+        if (i2c.read_regs16(regs, values) != SUCCESS) {
+            return I2C_READ_FAILURE;
+        }
+        if (!(values[3] & CNVR)) {
+            break;
+        }
+    }
+
+    snapshot.busPower_mW = parseBusPower_mW(values[0]);
+    snapshot.current_mA = parseCurrent_mA(values[1]);
+    snapshot.shuntVoltage_mV = parseShuntVoltage_mV(values[2]);
+    snapshot.busVoltage_mV = parseBusVoltage_mV(values[3]);
+    snapshot.supplyVoltage_mV = snapshot.busVoltage_mV + snapshot.shuntVoltage_mV;
+    snapshot.supplyPower_mW = snapshot.supplyVoltage_mV * snapshot.current_mA / 1000;
+    snapshot.sameConversion = !(values[3] & CNVR);
+    return values[3] & OVF ? I2C_BAD_DATA : SUCCESS;
+}
+
 Status INA219::modifyShunt(double newShuntResistance) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
     if (lastConfigInt < 0) {
@@ -266,8 +308,8 @@ Status INA219::modifyShunt(double newShuntResistance) {
     if (i == lastCalibInt) {
         return SUCCESS;
     }
-    int calStatus = wiringPiI2CWriteReg16(fd, CALIBRATION, i);
-    if (calStatus < 0) {
+    Status calStatus = i2c.write_reg16(CALIBRATION, i);
+    if (calStatus != SUCCESS) {
         lastCalibInt = -1;
         currentLSB = -1;
         powerLSB = -1;
@@ -279,56 +321,69 @@ Status INA219::modifyShunt(double newShuntResistance) {
 }
 
 Status INA219::reconfigure(ShuntVoltageRangeSetting v, int oversampling, bool busVoltageFullRange) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
     if (running < 0) {
         return I2C_PRIOR_WRITE_FAILURE;
     }
-    int i = configInt(v, oversampling, busVoltageFullRange, running);
+    int i = configInt(v, oversampling, busVoltageFullRange, activeMode(running));
     if (i == lastConfigInt) {
         return SUCCESS;
     }
-    int confStatus = wiringPiI2CWriteReg16(fd, CONFIGURATION, i);
-    if (confStatus < 0) {
+    Status confStatus = i2c.write_reg16(CONFIGURATION, i);
+    if (confStatus != SUCCESS) {
         lastConfigInt = -1;
         return I2C_WRITE_FAILURE;
     } else {
         lastConfigInt = i;
+        // kept for later configuration writes and the streaming conversion time
+        this->voltageRangeSetting = v;
+        this->oversampling = oversampling;
+        this->busVoltageFullRange = busVoltageFullRange;
+        triggerPending = false; // the write started a new conversion in triggered mode; poll for it afresh
+        if (streamMode != PowerDown) {
+            // The write restarted the ADC at the new conversion time, so the stream's timing starts over from here
+            streamStart = Clock::now();
+            lastReady = streamStart;
+            stats = {};
+        }
         return SUCCESS;
     }
 }
 
 Status INA219::setRunning(bool running) {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
     if (lastConfigInt < 0) {
         return I2C_PRIOR_WRITE_FAILURE;
     }
-    int i = configInt(voltageRangeSetting, oversampling, busVoltageFullRange, running);
+    int i = configInt(voltageRangeSetting, oversampling, busVoltageFullRange, activeMode(running));
     if (i == lastConfigInt) {
         return SUCCESS;
     }
     if (lastConfigInt < 0) {
         return I2C_PRIOR_WRITE_FAILURE;
     }
-    int confStatus = wiringPiI2CWriteReg16(fd, CONFIGURATION, i);
-    if (confStatus < 0) {
+    Status confStatus = i2c.write_reg16(CONFIGURATION, i);
+    if (confStatus != SUCCESS) {
         lastConfigInt = -1;
         return I2C_WRITE_FAILURE;
     } else {
         lastConfigInt = i;
+        this->running = running;
+        triggerPending = false;
         return SUCCESS;
     }
 }
 
 Status INA219::resetDevice() {
-    if (fd == -1) {
+    if (!i2c.is_open()) {
         return I2C_SETUP_FAILURE;
     }
-    int confStatus = wiringPiI2CWriteReg16(fd, CONFIGURATION, 1 << 15);
-    if (confStatus < 0) {
+    Status confStatus = i2c.write_reg16(CONFIGURATION, 1 << 15);
+    if (confStatus != SUCCESS) {
         lastConfigInt = -1;
         lastCalibInt = -1;
         running = -1;
@@ -337,6 +392,8 @@ Status INA219::resetDevice() {
         lastConfigInt = 0x399F;
         lastCalibInt = 0x0000;
         running = true;
+        streamMode = PowerDown;
+        triggerPending = false;
         busVoltageFullRange = true;
         voltageRangeSetting = PlusMinus_320_mV;
         oversampling = 0;
@@ -345,4 +402,184 @@ Status INA219::resetDevice() {
         powerLSB = 0;
         return SUCCESS;
     }
-}
\ No newline at end of file
+}
+// The mode to configure: the streaming mode while streaming, otherwise continuous unless stopped
+INA219::Mode INA219::activeMode(bool on) const {
+    if (!on) {
+        return PowerDown;
+    }
+    return streamMode != PowerDown ? streamMode : Continuous;
+}
+
+// Both ADCs use the same setting: 532 us for a 12-bit sample, and roughly that per sample when averaging
+std::chrono::microseconds INA219::conversionTime() const {
+    static constexpr std::array<int, 8> adcTime_us{532, 1060, 2130, 4260, 8510, 17020, 34050, 68100};
+    return 2 * std::chrono::microseconds(adcTime_us[std::clamp(oversampling, 0, 7)]);
+}
+
+Status INA219::startStreaming(Mode mode) {
+    if (!i2c.is_open()) {
+        return I2C_SETUP_FAILURE;
+    }
+    if (mode == PowerDown) {
+        return INVALID_INPUT;
+    }
+    if (lastConfigInt < 0) {
+        return I2C_PRIOR_WRITE_FAILURE;
+    }
+    // Written even if unchanged: a configuration write restarts the ADC and clears CNVR, so the first sample is a whole
+    // conversion, and in triggered mode it starts the first one
+    int i = configInt(voltageRangeSetting, oversampling, busVoltageFullRange, mode);
+    if (i2c.write_reg16(CONFIGURATION, i) != SUCCESS) {
+        lastConfigInt = -1;
+        streamMode = PowerDown;
+        return I2C_WRITE_FAILURE;
+    }
+    lastConfigInt = i;
+    running = true;
+    streamMode = mode;
+    triggerPending = mode == Triggered;
+    streamStart = Clock::now();
+    lastReady = streamStart;
+    stats = {};
+    return SUCCESS;
+}
+
+Status INA219::stopStreaming() {
+    if (streamMode == PowerDown) {
+        return SUCCESS;
+    }
+    streamMode = PowerDown;
+    triggerPending = false;
+    if (!i2c.is_open()) {
+        return I2C_SETUP_FAILURE;
+    }
+    int i = configInt(voltageRangeSetting, oversampling, busVoltageFullRange, Continuous);
+    if (i2c.write_reg16(CONFIGURATION, i) != SUCCESS) {
+        lastConfigInt = -1;
+        return I2C_WRITE_FAILURE;
+    }
+    lastConfigInt = i;
+    return SUCCESS;
+}
+
+// Sleeps until the conversion is due, then polls the bus voltage register until CNVR is set. readyAt is when the poll
+// that saw it started, the closest the driver can tell to when the conversion completed
+Status INA219::waitReady(Clock::time_point due, uint16_t& busVoltage, Clock::time_point& readyAt) {
+    Clock::duration period = conversionTime();
+    Clock::time_point deadline = due + 2 * period;
+    std::this_thread::sleep_until(due);
+    while (true) {
+        readyAt = Clock::now();
+        if (i2c.read_reg16(BUS_VOLTAGE, busVoltage) != SUCCESS) {
+            return I2C_READ_FAILURE;
+        }
+        if (busVoltage & CNVR) {
+            return SUCCESS;
+        }
+        stats.notReady++;
+        if (Clock::now() > deadline) {
+            return FAILURE;
+        }
+        std::this_thread::sleep_for(period / 16);
+    }
+}
+
+Status INA219::readNextSample(Sample& sample) {
+    if (!i2c.is_open()) {
+        return I2C_SETUP_FAILURE;
+    }
+    if (streamMode == PowerDown) {
+        return FAILURE;
+    }
+    if (streamMode == Triggered && !triggerPending) {
+        if (i2c.write_reg16(CONFIGURATION, lastConfigInt) != SUCCESS) {
+            return I2C_WRITE_FAILURE;
+        }
+        triggerPending = true;
+        lastReady = Clock::now();
+    }
+
+    Clock::duration period = conversionTime();
+    uint16_t busVoltage;
+    Clock::time_point readyAt;
+    Status ready = waitReady(lastReady + period, busVoltage, readyAt);
+    if (ready != SUCCESS) {
+        // Start afresh next time: a new trigger in Triggered mode, a full wait from now in Continuous, rather than
+        // polling once past a deadline that has already gone
+        triggerPending = false;
+        lastReady = Clock::now();
+        return ready;
+    }
+
+    // Power last: reading it clears CNVR, so the next poll only sees the next conversion
+    std::array<uint8_t, 3> regs{SHUNT_VOLTAGE, CURRENT, POWER};
+    std::array<uint16_t, 3> values;
+    if (i2c.read_regs16(regs, values) != SUCCESS) {
+        return I2C_READ_FAILURE;
+    }
+
+    triggerPending = false;
+    lastReady = readyAt;
+    stats.samples++;
+    if (streamMode == Continuous) {
+        // Conversions complete every period from the start whether read or not; those not read were overwritten.
+        // Counted over the whole stream, so the estimate is as good as the ADC clock's tolerance
+        uint64_t completed = static_cast<uint64_t>((readyAt - streamStart) / period);
+        stats.missed = std::max(stats.missed, completed - std::min(completed, stats.samples));
+    }
+
+    sample.time_us = std::chrono::duration_cast<std::chrono::microseconds>(readyAt.time_since_epoch()).count();
+    sample.shuntVoltage = values[0];
+    sample.busVoltage = busVoltage;
+    sample.current = values[1];
+    sample.power = values[2];
+    return busVoltage & OVF ? I2C_BAD_DATA : SUCCESS;
+}
+
+Status INA219::submitRead() {
+    if (!i2c.is_open()) {
+        return I2C_SETUP_FAILURE;
+    }
+    if (currentLSB < 0) {
+        return I2C_PRIOR_WRITE_FAILURE;
+    }
+    if (pendingRead.valid()) {
+        return FAILURE;
+    }
+    // Bus voltage first for its overflow flag, and power last, as in readNextSample
+    readPointers = {BUS_VOLTAGE, SHUNT_VOLTAGE, CURRENT, POWER};
+    for (size_t i = 0; i < readPointers.size(); i++) {
+        readMessages[2 * i] = {&readPointers[i], 1, false};
+        readMessages[2 * i + 1] = {&readData[2 * i], 2, true};
+    }
+    readSubmitted = Clock::now();
+    pendingRead = i2c.submit(readMessages);
+    return SUCCESS;
+}
+
+Status INA219::collectRead(Sample& sample) {
+    if (!pendingRead.valid()) {
+        return FAILURE;
+    }
+    if (pendingRead.get() != SUCCESS) {
+        return I2C_READ_FAILURE;
+    }
+    std::array<uint16_t, 4> values;
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<uint16_t>(readData[2 * i] << 8 | readData[2 * i + 1]);
+    }
+    sample.time_us = std::chrono::duration_cast<std::chrono::microseconds>(readSubmitted.time_since_epoch()).count();
+    sample.busVoltage = values[0];
+    sample.shuntVoltage = values[1];
+    sample.current = values[2];
+    sample.power = values[3];
+    return values[0] & OVF ? I2C_BAD_DATA : SUCCESS;
+}
+
+INA219::StreamStats INA219::streamStats() const {
+    StreamStats out = stats;
+    double elapsed = std::chrono::duration<double>(lastReady - streamStart).count();
+    out.samplesPerSecond = elapsed > 0 ? out.samples / elapsed : 0;
+    return out;
+}
@@ -1,9 +1,14 @@
 #ifndef RAPID_CDH_INA219_H
 #define RAPID_CDH_INA219_H
 
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <future>
+#include <span>
 
 #include "../globals.h"
+#include "I2CDevice.h"
 
 class INA219 {
 public:
@@ -30,6 +35,40 @@ public:
         CALIBRATION = 5
     };
 
+    // ADC operating modes; both convert the shunt voltage and then the bus voltage
+    enum Mode {
+        PowerDown = 0b000,
+        Triggered = 0b011, // one conversion per write of the configuration register
+        Continuous = 0b111
+    };
+
+    // The registers of one conversion, raw; convert them with the parse functions
+    struct Sample {
+        uint64_t time_us; // steady_clock time the conversion was seen ready, or the read submitted, in microseconds
+        uint16_t shuntVoltage;
+        uint16_t busVoltage;
+        uint16_t current;
+        uint16_t power;
+    };
+
+    // One conversion's readings, and the supply-side values derived from them; see getSnapshot
+    struct Snapshot {
+        double shuntVoltage_mV;
+        double busVoltage_mV;    // after the sensing resistor
+        double supplyVoltage_mV; // before it: bus plus shunt
+        double current_mA;
+        double busPower_mW;      // from the power register
+        double supplyPower_mW;   // supply voltage times current
+        bool sameConversion;     // false if a conversion completed during the last read, so the values may mix two
+    };
+
+    struct StreamStats {
+        uint64_t samples;
+        uint64_t missed;   // conversions that completed and were overwritten before being read, from their timing
+        uint64_t notReady; // polls of the conversion-ready bit that found no new conversion
+        double samplesPerSecond;
+    };
+
     // if the parameter for oversampling is n, the amount of oversampling done by the ADC is 2^n (e.g, n = 2 means 4 samples are averaged)
     // bus voltage full range is 32V, alternative is 16V
     INA219(
@@ -40,22 +79,59 @@ public:
     [[nodiscard]] Status getShuntVoltage_mV(double& value);
     [[nodiscard]] Status getShuntVoltageRaw(uint16_t& value);
     double parseShuntVoltage_mV(uint16_t raw);
+    void parseShuntVoltages_mV(std::span<const uint16_t> raw, std::span<float> values);
     // supply voltage BEFORE the sensing resistor; exceeds the value observed by the component over which current is measured
     [[nodiscard]] Status getSupplyVoltage_mV(double& value);
     // supply voltage AFTER the sensing resistor; less than the battery / supply voltage
     [[nodiscard]] Status getBusVoltage_mV(double& value);
     [[nodiscard]] Status getBusVoltageRaw(uint16_t& value);
     double parseBusVoltage_mV(uint16_t raw);
+    void parseBusVoltages_mV(std::span<const uint16_t> raw, std::span<float> values);
 
     [[nodiscard]] Status getCurrent_mA(double& value);
     [[nodiscard]] Status getCurrentRaw(uint16_t& value);
     double parseCurrent_mA(uint16_t raw);
+    void parseCurrents_mA(std::span<const uint16_t> raw, std::span<float> values);
     // supply power is the amount drawn from the batteries; exceeds the power received by the component over which measurements are being taken
     [[nodiscard]] Status getSupplyPower_mW(double& value);
     // bus power is the amount used by the component over which measurements are being taken; less than the power drawn from the batteries / supply
     [[nodiscard]] Status getBusPower_mW(double& value);
     [[nodiscard]] Status getBusPowerRaw(uint16_t& value);
     double parseBusPower_mW(uint16_t raw);
+    // The batch parse functions convert min(raw.size(), values.size()) readings, as the single-reading versions do
+    void parseBusPowers_mW(std::span<const uint16_t> raw, std::span<float> values);
+
+    // All four measurement registers in one transaction, for every value above at the cost of one round trip. Power is
+    // read first, clearing CNVR, and bus voltage last; CNVR set again by then means a conversion landed mid-read. Only
+    // if consistent is set is the read then retried, up to twice more. At 100 kHz four registers take longer than a
+    // 12-bit conversion, so use 400 kHz or oversampling for retries to help. I2C_BAD_DATA, with snapshot filled in, if
+    // the current or power overflowed
+    [[nodiscard]] Status getSnapshot(Snapshot& snapshot, bool consistent = false);
+
+    // Streaming reads each conversion exactly once: it polls the conversion-ready bit (CNVR) in the bus voltage
+    // register, then reads the conversion's registers, reading power last to clear the bit. Continuous streams at the
+    // rate the oversampling setting allows; Triggered starts each conversion when the previous one has been read.
+    // Anything else that reads the power register while streaming clears CNVR and so takes that conversion from the
+    // stream: getBusPower_mW, getBusPowerRaw, getSupplyPower_mW, getSnapshot and submitRead, as an INA219RailGroup
+    // does. INVALID_INPUT for PowerDown
+    [[nodiscard]] Status startStreaming(Mode mode);
+    // Waits for the next conversion and reads it. FAILURE if not streaming or no conversion is ready within two
+    // conversion times of when it was due, after which the next call triggers (in Triggered mode) and waits afresh;
+    // I2C_BAD_DATA, with sample filled in, if the current or power overflowed
+    [[nodiscard]] Status readNextSample(Sample& sample);
+    // Back to free-running continuous conversions read blindly by the getters
+    [[nodiscard]] Status stopStreaming();
+    // Split-phase read of the latest conversion, for polling several INA219s on one bus: submitRead queues reads of the
+    // bus voltage, shunt voltage, current and power registers and returns at once, so reads submitted together can
+    // share a transfer, and collectRead waits for them. One read at a time; FAILURE from collectRead if none is
+    // pending, I2C_BAD_DATA, with sample filled in, if the current or power overflowed
+    [[nodiscard]] Status submitRead();
+    [[nodiscard]] Status collectRead(Sample& sample);
+
+    // Since streaming last started, or reconfigure last changed the configuration while streaming
+    StreamStats streamStats() const;
+    // How long one shunt and bus conversion takes with the current oversampling
+    std::chrono::microseconds conversionTime() const;
 
     [[nodiscard]] Status modifyShunt(double newShuntResistance);
     [[nodiscard]] Status reconfigure(ShuntVoltageRangeSetting v, int oversampling, bool busVoltageFullRange);
@@ -65,7 +141,13 @@ public:
     [[nodiscard]] Status resetDevice();
 
 private:
-    int fd;
+    using Clock = std::chrono::steady_clock;
+
+    Status readValidated(Registers reg, uint16_t& value);
+    Mode activeMode(bool on) const;
+    Status waitReady(Clock::time_point due, uint16_t& busVoltage, Clock::time_point& readyAt);
+
+    I2CDevice i2c;
     Status ctrRes;
 
     double shuntResistance;
@@ -78,6 +160,19 @@ private:
     int running; // 0 = false, 1 = true, -1 = unknown due to error
     bool busVoltageFullRange;
     int lastConfigInt;
+
+    Mode streamMode = PowerDown; // PowerDown when not streaming
+    bool triggerPending = false; // a triggered conversion has been started and not yet read
+    Clock::time_point streamStart;
+    Clock::time_point lastReady; // when the last conversion was seen ready, or a triggered one started
+    StreamStats stats{};
+
+    // The split-phase read in flight; the bus writes into these until pendingRead is ready
+    std::array<uint8_t, 4> readPointers{};
+    std::array<uint8_t, 8> readData{};
+    std::array<I2CDevice::Message, 8> readMessages{};
+    std::future<Status> pendingRead;
+    Clock::time_point readSubmitted;
 };
 
 #endif
\ No newline at end of file
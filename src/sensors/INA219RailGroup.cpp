@@ -0,0 +1,194 @@
+#include "INA219RailGroup.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Bits one rail's read puts on the bus: for each of its four registers, a start, the address and the pointer, then
+    // a repeated start, the address and two data bytes, every byte with its acknowledge bit
+    constexpr uint64_t BITS_PER_READ = 4 * ((1 + 9 + 9) + (1 + 9 + 2 * 9));
+}
+
+INA219RailGroup::Rail::Rail(const char* device, const RailConfig& config)
+    : monitor(std::make_unique<INA219>(device, config.addr0, config.addr1, config.shuntResistance, config.range,
+                                       config.oversampling)),
+      rate_hz(config.rate_hz),
+      period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / config.rate_hz))) {}
+
+INA219RailGroup::INA219RailGroup(const char* device, std::vector<RailConfig> rails, uint32_t bus_clock_hz,
+                                 Handler handler)
+    : m_bus(I2CBus::open(device)), m_bus_clock_hz(bus_clock_hz), m_handler(std::move(handler)) {
+    std::vector<int> addresses;
+    for (const RailConfig& config : rails) {
+        addresses.push_back(config.addr0 + 4 * config.addr1);
+    }
+    std::sort(addresses.begin(), addresses.end());
+    if (std::adjacent_find(addresses.begin(), addresses.end()) != addresses.end()) {
+        return; // No rails; init reports it
+    }
+    for (const RailConfig& config : rails) {
+        m_rails.push_back(config.rate_hz > 0 ? std::make_unique<Rail>(device, config) : nullptr);
+    }
+}
+
+INA219RailGroup::~INA219RailGroup() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+Status INA219RailGroup::init() {
+    if (m_thread.joinable()) {
+        return SUCCESS;
+    }
+    if (m_rails.empty()) {
+        return INVALID_INPUT;
+    }
+    for (const std::unique_ptr<Rail>& rail : m_rails) {
+        if (!rail || rail->period < rail->monitor->conversionTime()) {
+            return INVALID_INPUT;
+        }
+    }
+    for (const std::unique_ptr<Rail>& rail : m_rails) {
+        Status status = rail->monitor->init();
+        if (status != SUCCESS) {
+            return status;
+        }
+    }
+
+    m_start = Clock::now();
+    m_thread = std::thread(&INA219RailGroup::run, this);
+    return SUCCESS;
+}
+
+Status INA219RailGroup::latest(size_t rail, Reading& reading) const {
+    if (rail >= m_rails.size() || !m_rails[rail]) {
+        return INVALID_INPUT;
+    }
+    std::lock_guard<std::mutex> lock(m_latest_mutex);
+    if (!m_rails[rail]->read) {
+        return FAILURE;
+    }
+    reading = m_rails[rail]->latest;
+    return SUCCESS;
+}
+
+INA219RailGroup::RailStats INA219RailGroup::stats(size_t rail) const {
+    if (rail >= m_rails.size() || !m_rails[rail] || !m_thread.joinable()) {
+        return {};
+    }
+    const Rail& r = *m_rails[rail];
+    RailStats out{};
+    out.rate_hz = r.rate_hz;
+    out.readings = r.readings.load(std::memory_order_relaxed);
+    out.failures = r.failures.load(std::memory_order_relaxed);
+    out.skipped = r.skipped.load(std::memory_order_relaxed);
+    double elapsed = std::chrono::duration<double>(Clock::now() - m_start).count();
+    out.achieved_hz = elapsed > 0 ? out.readings / elapsed : 0;
+    out.busUtilization = utilization(out.readings + out.failures);
+    return out;
+}
+
+double INA219RailGroup::busUtilization() const {
+    uint64_t reads = 0;
+    for (const std::unique_ptr<Rail>& rail : m_rails) {
+        if (rail) {
+            reads += rail->readings.load(std::memory_order_relaxed) + rail->failures.load(std::memory_order_relaxed);
+        }
+    }
+    return utilization(reads);
+}
+
+uint64_t INA219RailGroup::sweeps() const {
+    return m_sweeps.load(std::memory_order_relaxed);
+}
+
+size_t INA219RailGroup::rails() const {
+    return m_rails.size();
+}
+
+// Time on the wire for reads, as a fraction of the time since the group started
+double INA219RailGroup::utilization(uint64_t reads) const {
+    if (!m_thread.joinable()) {
+        return 0;
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - m_start).count();
+    return elapsed > 0 ? static_cast<double>(reads * BITS_PER_READ) / m_bus_clock_hz / elapsed : 0;
+}
+
+void INA219RailGroup::publish(Rail& rail, size_t index, const INA219::Sample& sample) {
+    INA219& monitor = *rail.monitor;
+    Reading reading{sample.time_us, monitor.parseShuntVoltage_mV(sample.shuntVoltage),
+                    monitor.parseBusVoltage_mV(sample.busVoltage), monitor.parseCurrent_mA(sample.current),
+                    monitor.parseBusPower_mW(sample.power)};
+    {
+        std::lock_guard<std::mutex> lock(m_latest_mutex);
+        rail.latest = reading;
+        rail.read = true;
+    }
+    rail.readings.fetch_add(1, std::memory_order_relaxed);
+    if (m_handler) {
+        m_handler(index, reading);
+    }
+}
+
+void INA219RailGroup::run() {
+    for (const std::unique_ptr<Rail>& rail : m_rails) {
+        rail->next = m_start;
+    }
+
+    std::vector<size_t> due;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        Clock::time_point now = Clock::now();
+        Clock::time_point wake = Clock::time_point::max();
+        due.clear();
+        for (size_t i = 0; i < m_rails.size(); i++) {
+            if (m_rails[i]->next <= now) {
+                due.push_back(i);
+            } else {
+                wake = std::min(wake, m_rails[i]->next);
+            }
+        }
+        if (due.empty()) {
+            m_wake.wait_until(lock, wake, [this]() { return m_stopping; });
+            continue;
+        }
+
+        lock.unlock();
+        {
+            // Everything submitted under the batch leaves together once it ends
+            I2CBus::Batch batch(*m_bus);
+            for (size_t i : due) {
+                if (m_rails[i]->monitor->submitRead() != SUCCESS) {
+                    m_rails[i]->failures.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        for (size_t i : due) {
+            Rail& rail = *m_rails[i];
+            INA219::Sample sample;
+            Status status = rail.monitor->collectRead(sample);
+            if (status == SUCCESS) {
+                publish(rail, i, sample);
+            } else if (status != FAILURE) { // FAILURE: the submit already failed and was counted
+                rail.failures.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Keep to the rail's rate, but skip the slots missed if the thread fell behind rather than bursting
+            rail.next += rail.period;
+            if (rail.next <= now) {
+                uint64_t missed = (now - rail.next) / rail.period + 1;
+                rail.skipped.fetch_add(missed, std::memory_order_relaxed);
+                rail.next += missed * rail.period;
+            }
+        }
+        m_sweeps.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef RAPIDCDH_INA219RAILGROUP_H
+#define RAPIDCDH_INA219RAILGROUP_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../globals.h"
+#include "I2CBus.h"
+#include "INA219.h"
+
+// Polls the INA219s of a power board, one per rail, all on one bus, each at its own rate, on a thread of its own.
+// Rails that fall due together are read in one sweep: their reads are submitted as one batch, so the bus sends them in
+// as few transfers as fit them (five rails per transfer), instead of each rail paying for its own. Readers get each
+// rail's latest reading from any thread, and a handler, e.g. feeding an EnergyAccumulator, can see every reading.
+//
+// The INA219s run continuously and are read blindly, so a rate above one per conversion time reads the same
+// conversion twice; init rejects it. While the group runs it is the only user of its INA219s.
+class INA219RailGroup {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct RailConfig {
+        INA219::AddrSelect addr0;
+        INA219::AddrSelect addr1;
+        double shuntResistance; // ohms
+        double rate_hz;
+        INA219::ShuntVoltageRangeSetting range = INA219::PlusMinus_40_mV;
+        int oversampling = 0;
+    };
+
+    struct Reading {
+        uint64_t time_us; // Clock time the sweep that read it started, in microseconds
+        double shuntVoltage_mV;
+        double busVoltage_mV;
+        double current_mA;
+        double power_mW;
+    };
+
+    struct RailStats {
+        double rate_hz;        // Configured
+        double achieved_hz;    // Readings per second since the group started
+        uint64_t readings;
+        uint64_t failures;     // Reads that failed on the bus or overflowed; no reading is published for them
+        uint64_t skipped;      // Due times dropped because a sweep ran late
+        double busUtilization; // Fraction of the bus's time spent on this rail's reads, from the bits they put on it
+    };
+
+    // Called on the polling thread with the rail's index and each new reading; it delays the next sweep while it runs
+    using Handler = std::function<void(size_t rail, const Reading& reading)>;
+
+    // The INA219s are opened on device, whose clock is bus_clock_hz, for the utilization figures
+    INA219RailGroup(const char* device, std::vector<RailConfig> rails, uint32_t bus_clock_hz = 100000,
+                    Handler handler = nullptr);
+    // Stops polling and joins the thread
+    ~INA219RailGroup();
+
+    INA219RailGroup(const INA219RailGroup&) = delete;
+    INA219RailGroup& operator=(const INA219RailGroup&) = delete;
+
+    // Starts polling. INVALID_INPUT if there are no rails, two share an address, or a rate is not positive or faster
+    // than the rail's conversions; otherwise the first INA219 init status that is not SUCCESS
+    [[nodiscard]] Status init();
+
+    // Most recent reading of a rail. Any thread. INVALID_INPUT if there is no such rail, FAILURE if it has not been
+    // read yet
+    [[nodiscard]] Status latest(size_t rail, Reading& reading) const;
+    [[nodiscard]] RailStats stats(size_t rail) const;
+    // All the rails' reads together, as a fraction of the bus's time
+    [[nodiscard]] double busUtilization() const;
+    // Sweeps run; each reads every rail due at the time
+    [[nodiscard]] uint64_t sweeps() const;
+
+    [[nodiscard]] size_t rails() const;
+
+private:
+    struct Rail {
+        explicit Rail(const char* device, const RailConfig& config);
+
+        std::unique_ptr<INA219> monitor;
+        double rate_hz;
+        Clock::duration period;
+        Clock::time_point next{};
+        std::atomic<uint64_t> readings{0};
+        std::atomic<uint64_t> failures{0};
+        std::atomic<uint64_t> skipped{0};
+        Reading latest{}; // These two guarded by m_latest_mutex
+        bool read = false;
+    };
+
+    void run();
+    void publish(Rail& rail, size_t index, const INA219::Sample& sample);
+    double utilization(uint64_t reads) const;
+
+    std::shared_ptr<I2CBus> m_bus;
+    uint32_t m_bus_clock_hz;
+    Handler m_handler;
+    std::vector<std::unique_ptr<Rail>> m_rails;
+    std::atomic<uint64_t> m_sweeps{0};
+    Clock::time_point m_start;
+
+    mutable std::mutex m_latest_mutex;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake; // Signalled on shutdown
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+
+#endif //RAPIDCDH_INA219RAILGROUP_H
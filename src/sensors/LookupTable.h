@@ -0,0 +1,61 @@
+#ifndef RAPIDCDH_LOOKUPTABLE_H
+#define RAPIDCDH_LOOKUPTABLE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace conversion {
+    // Maps 12-bit ADC codes, such as the ADS7828's, to engineering units along a curve too costly to evaluate per
+    // sample. The curve is sampled every SEGMENT_CODES codes and interpolated linearly in between. Each segment keeps
+    // its start value and slope side by side, so a lookup is one 8-byte load and a multiply-add. The constructor is
+    // constexpr: a table built from hardware constants is generated by the compiler and rebuilt whenever they change.
+    class LookupTable {
+    public:
+        static constexpr int CODE_BITS = 12;
+        static constexpr int SEGMENT_BITS = 4;
+        static constexpr int SEGMENT_CODES = 1 << SEGMENT_BITS;
+        static constexpr uint16_t MAX_CODE = (1 << CODE_BITS) - 1;
+
+        // value_at(code) is evaluated every SEGMENT_CODES codes from 0 up to and including 1 << CODE_BITS, the end
+        // of the top segment
+        template <typename F>
+        constexpr explicit LookupTable(F value_at) {
+            for (size_t i = 0; i < SEGMENTS; i++) {
+                double start = value_at(static_cast<double>(i << SEGMENT_BITS));
+                double end = value_at(static_cast<double>((i + 1) << SEGMENT_BITS));
+                m_segments[i] = {static_cast<float>(start), static_cast<float>((end - start) / SEGMENT_CODES)};
+            }
+        }
+
+        // Codes above MAX_CODE read as MAX_CODE
+        constexpr float operator()(uint16_t raw) const {
+            raw = std::min(raw, MAX_CODE);
+            const Segment& segment = m_segments[raw >> SEGMENT_BITS];
+            return segment.start + segment.slope * static_cast<float>(raw & (SEGMENT_CODES - 1));
+        }
+
+    private:
+        static constexpr size_t SEGMENTS = 1 << (CODE_BITS - SEGMENT_BITS);
+
+        struct Segment {
+            float start = 0;
+            float slope = 0;
+        };
+
+        std::array<Segment, SEGMENTS> m_segments{};
+    };
+
+    // Converts min(raw.size(), out.size()) codes, as the other maps' convert
+    inline void convert(std::span<const uint16_t> raw, const LookupTable& map, std::span<float> out) {
+        size_t count = std::min(raw.size(), out.size());
+        for (size_t i = 0; i < count; i++) {
+            out[i] = map(raw[i]);
+        }
+    }
+}
+
+
+#endif //RAPIDCDH_LOOKUPTABLE_H
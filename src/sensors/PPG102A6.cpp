@@ -1,42 +1,143 @@
 #include "PPG102A6.h"
 
-#include <wiringPi.h>
+#include <algorithm>
+#include <limits>
 
 #include "../globals.h"
 #include "ADS7828.h"
+#include "ADS7828Sampler.h"
+#include "Gpio.h"
 
-PPG102A6::PPG102A6(ADS7828* sensor, int channel, int gpioPin) {
-	resistanceAtZero = 1000;
-	ppmPerDegree = 3850;
-	topVoltage = 5;
-	
+namespace {
+	// A 1000 ohm platinum RTD to IEC 60751 (3850 ppm/K): Callendar-Van Dusen
+	// R(T) = R0 * (1 + A*T + B*T^2 + C*(T - 100)*T^3), with the C term below 0 C only
+	constexpr double RESISTANCE_AT_ZERO = 1000;
+	constexpr double CVD_A = 3.9083e-3;
+	constexpr double CVD_B = -5.775e-7;
+	constexpr double CVD_C = -4.183e-12;
+	// The range the equation covers; readings beyond it, such as an open or shorted RTD, clamp to its ends
+	constexpr double MIN_TEMPERATURE = -200;
+	constexpr double MAX_TEMPERATURE = 850;
+
+	// The divider is excited from its GPIO pin, RTD on top, and the ADC reads the voltage across the fixed resistor
+	constexpr double TOP_VOLTAGE = constants::GPIO_HIGH_VOLTAGE;
 	// Expected resistance of the RTD at 50 degrees C.
 	// Choosing this value maximizes the minimum value for
 	// d(Voltage)/d(Temperature) on the range -40 to +50
 	// degrees C. If this exact value of resistor cannot be
 	// ordered, the real value should be placed here instead.
-	dividerResistance = 1192.5;
+	constexpr double DIVIDER_RESISTANCE = 1192.5;
+
+	constexpr double resistanceAt(double celsius) {
+		double c = celsius < 0 ? CVD_C : 0;
+		return RESISTANCE_AT_ZERO * (1 + CVD_A * celsius + CVD_B * celsius * celsius +
+				c * (celsius - 100) * celsius * celsius * celsius);
+	}
+
+	// Inverts resistanceAt by Newton's method from the linear estimate; eight steps are exact to double precision
+	// over the whole range
+	constexpr double temperatureAt(double resistance) {
+		if (resistance >= resistanceAt(MAX_TEMPERATURE)) {
+			return MAX_TEMPERATURE;
+		}
+		if (resistance <= resistanceAt(MIN_TEMPERATURE)) {
+			return MIN_TEMPERATURE;
+		}
+		double t = (resistance / RESISTANCE_AT_ZERO - 1) / CVD_A;
+		for (int i = 0; i < 8; i++) {
+			double c = t < 0 ? CVD_C : 0;
+			double slope = RESISTANCE_AT_ZERO * (CVD_A + 2 * CVD_B * t + c * (4 * t * t * t - 300 * t * t));
+			t -= (resistanceAt(t) - resistance) / slope;
+		}
+		return t;
+	}
+
+	constexpr conversion::LookupTable buildTable(double referenceVoltage) {
+		return conversion::LookupTable([referenceVoltage](double code) {
+			// using V = IR, assuming low-side reference resistor
+			double voltage = code * referenceVoltage / (1 << 12);
+			if (voltage <= 0) {
+				return MAX_TEMPERATURE; // no current: the RTD is open
+			}
+			return temperatureAt(DIVIDER_RESISTANCE * (TOP_VOLTAGE - voltage) / voltage);
+		});
+	}
 
+	constexpr conversion::LookupTable DEFAULT_TABLE = buildTable(ADS7828::DEFAULT_REFERENCE_VOLTAGE);
+
+	// The range the divider was designed for, which the default table must cover without reaching either end of the
+	// ADC's range
+	constexpr double DESIGN_MIN_TEMPERATURE = -40;
+	constexpr double DESIGN_MAX_TEMPERATURE = 50;
+
+	constexpr double codeAt(double celsius, double referenceVoltage) {
+		double resistance = resistanceAt(celsius);
+		return TOP_VOLTAGE * DIVIDER_RESISTANCE / (DIVIDER_RESISTANCE + resistance) / referenceVoltage * (1 << 12);
+	}
+
+	// Colder is a higher code
+	constexpr double DESIGN_MIN_CODE = codeAt(DESIGN_MIN_TEMPERATURE, ADS7828::DEFAULT_REFERENCE_VOLTAGE);
+	constexpr double DESIGN_MAX_CODE = codeAt(DESIGN_MAX_TEMPERATURE, ADS7828::DEFAULT_REFERENCE_VOLTAGE);
+	static_assert(DESIGN_MIN_CODE < conversion::LookupTable::MAX_CODE && DESIGN_MAX_CODE > 0,
+			"the divider's design range falls outside the ADC's range");
+
+	constexpr uint16_t ROOM_CODE = static_cast<uint16_t>(codeAt(20, ADS7828::DEFAULT_REFERENCE_VOLTAGE) + 0.5);
+	static_assert(DEFAULT_TABLE(ROOM_CODE) > 19.9 && DEFAULT_TABLE(ROOM_CODE) < 20.1,
+			"the RTD table does not invert the divider");
+
+	// The divider's voltage is at or beyond the reference, so the code says nothing about the temperature. With the
+	// default reference that is below about -150 C, which in practice means a shorted RTD
+	constexpr bool saturated(uint16_t raw) {
+		return raw >= conversion::LookupTable::MAX_CODE;
+	}
+
+	conversion::LookupTable tableFor(double voltsPerCode) {
+		double referenceVoltage = voltsPerCode * (1 << 12);
+		return referenceVoltage == ADS7828::DEFAULT_REFERENCE_VOLTAGE ? DEFAULT_TABLE : buildTable(referenceVoltage);
+	}
+}
+
+PPG102A6::PPG102A6(ADS7828* sensor, int channel, int gpioPin) : table(tableFor(sensor->parseRawVoltage(1))) {
 	this->sensor = sensor;
 	this->channel = channel;
 	this->gpioPin = gpioPin;
 
-	pinMode(gpioPin, OUTPUT);
-	pullUpDnControl(gpioPin, PUD_OFF);
-	digitalWrite(gpioPin, LOW);
+	gpio::set_output(gpioPin);
+}
+
+PPG102A6::PPG102A6(ADS7828Sampler* sampler, int channel) : table(tableFor(sampler->voltage(1))) {
+	this->sampler = sampler;
+	this->channel = channel;
 }
 
 Status PPG102A6::getTemperature(double& value) {
-	digitalWrite(gpioPin, HIGH);
-	double voltage = topVoltage / 2;
-	Status s = sensor->readChannelCommonAnode(channel, voltage);
-	digitalWrite(gpioPin, LOW);
-	// using V = IR, assuming low-side reference resistor
-	double current = voltage / dividerResistance;
-	double resistance = (topVoltage - voltage) / current;
-	// using R = R0 * (10^6 + ppm * T)
-	if (s == SUCCESS) {
-		value = (resistance / resistanceAtZero - 1000000) / ppmPerDegree;
-	}
-	return s;
+	uint16_t raw = 0;
+	Status s;
+	if (sampler) {
+		ADS7828Sampler::Sample sample{};
+		s = sampler->latest(channel, sample);
+		raw = sample.raw;
+	} else {
+		gpio::write(gpioPin, true);
+		s = sensor->readChannelCommonAnodeRaw(channel, raw);
+		gpio::write(gpioPin, false);
+	}
+	if (s != SUCCESS) {
+		return s;
+	}
+	if (saturated(raw)) {
+		return I2C_BAD_DATA;
+	}
+	value = table(raw);
+	return SUCCESS;
+}
+
+void PPG102A6::parseTemperatures(std::span<const uint16_t> raw, std::span<float> values) {
+	conversion::convert(raw, table, values);
+	size_t count = std::min(raw.size(), values.size());
+	for (size_t i = 0; i < count; i++) {
+		if (saturated(raw[i])) {
+			values[i] = std::numeric_limits<float>::quiet_NaN();
+		}
+	}
 }
\ No newline at end of file
@@ -1,24 +1,36 @@
 #ifndef RAPID_CDH_PPG102A6_H
 #define RAPID_CDH_PPG102A6_H
 
+#include <cstdint>
+#include <span>
+
 #include "../globals.h"
+#include "LookupTable.h"
 
 class ADS7828;
+class ADS7828Sampler;
 
 class PPG102A6 {
     public:
         PPG102A6(ADS7828* sensor, int channel, int gpioPin);
+        // Converts the channel's latest sample from sampler rather than reading the ADC. The sampler drives the
+        // divider's GPIO, given as the channel's excitation_pin
+        PPG102A6(ADS7828Sampler* sampler, int channel);
         // note that there are no error codes related to the gpio pin because
         // gpio failures are silent in the wiringpi library
+        // Covers about -150 to 850 C with the ADS7828's internal reference. I2C_BAD_DATA for a full-scale code, which
+        // is beyond the divider's range rather than a temperature
         [[nodiscard]] Status getTemperature(double& value);
+        // Converts raw ADC codes from this sensor's channel, e.g. drained from a sampler, to degrees C; full-scale codes
+        // become NaN
+        void parseTemperatures(std::span<const uint16_t> raw, std::span<float> values);
     private:
-        double resistanceAtZero;
-        double ppmPerDegree;
-        ADS7828* sensor;
-        double dividerResistance;
-        double topVoltage;
+        ADS7828* sensor = nullptr;
+        ADS7828Sampler* sampler = nullptr;
+        // ADC code to degrees C: built at compile time for the ADS7828's default reference, otherwise at construction
+        conversion::LookupTable table;
         int channel;
-        int gpioPin;
+        int gpioPin = -1;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,13 @@
+#include "SpiBackend.h"
+
+namespace {
+    SpiBackend* installed = nullptr;
+}
+
+SpiBackend& SpiBackend::current() {
+    return installed ? *installed : platform();
+}
+
+void SpiBackend::install(SpiBackend* backend) {
+    installed = backend;
+}
@@ -0,0 +1,30 @@
+#ifndef RAPIDCDH_SPIBACKEND_H
+#define RAPIDCDH_SPIBACKEND_H
+
+#include <cstdint>
+#include <span>
+
+// What SPI drivers talk through: wiringPi's SPI on the target (SpiWiringPi.cpp), or a simulated bus (see src/sim).
+// Drivers take the backend installed when they are constructed
+class SpiBackend {
+public:
+    virtual ~SpiBackend() = default;
+
+    // Opens chip select channel at speed Hz
+    [[nodiscard]] virtual bool setup(uint8_t channel, uint32_t speed) = 0;
+    // Full duplex: sends data and overwrites it with the bytes clocked in
+    [[nodiscard]] virtual bool transfer(uint8_t channel, std::span<uint8_t> data) = 0;
+
+    // The installed backend, or the platform's own if none is
+    static SpiBackend& current();
+    // Makes backend current until another is installed; nullptr goes back to the platform's own.
+    // Not thread-safe: install before constructing the drivers that use it
+    static void install(SpiBackend* backend);
+
+private:
+    // Defined by the platform: SpiWiringPi.cpp on the target, src/sim/SimSpiBackend.cpp in the simulation build
+    static SpiBackend& platform();
+};
+
+
+#endif //RAPIDCDH_SPIBACKEND_H
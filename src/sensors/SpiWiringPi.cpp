@@ -0,0 +1,21 @@
+#include "SpiBackend.h"
+
+#include <wiringPiSPI.h>
+
+namespace {
+    class WiringPiSpi : public SpiBackend {
+    public:
+        bool setup(uint8_t channel, uint32_t speed) override {
+            return wiringPiSPISetup(channel, static_cast<int>(speed)) >= 0;
+        }
+
+        bool transfer(uint8_t channel, std::span<uint8_t> data) override {
+            return wiringPiSPIDataRW(channel, data.data(), static_cast<int>(data.size())) >= 0;
+        }
+    };
+}
+
+SpiBackend& SpiBackend::platform() {
+    static WiringPiSpi spi;
+    return spi;
+}
@@ -0,0 +1,70 @@
+#ifndef RAPIDCDH_SPSCRING_H
+#define RAPIDCDH_SPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread. Each side owns one index and only
+// reads the other's, so a push or pop is a couple of loads and one release store; a full ring fails the push.
+template <typename T>
+class SpscRing {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        m_mask = size - 1;
+        m_cells = std::make_unique<T[]>(size);
+    }
+
+    // Producer thread only. Returns false if the ring is full
+    bool try_push(const T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head_cache > m_mask) {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail - m_head_cache > m_mask) {
+                return false;
+            }
+        }
+
+        m_cells[tail & m_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Returns false if the ring is empty
+    bool try_pop(T& value) {
+        return pop(std::span<T>(&value, 1)) == 1;
+    }
+
+    // Consumer thread only. Moves as many values as are available, up to values.size(), oldest first. Returns the
+    // number moved
+    size_t pop(std::span<T> values) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t count = std::min(m_tail.load(std::memory_order_acquire) - head, values.size());
+        for (size_t i = 0; i < count; i++) {
+            values[i] = m_cells[(head + i) & m_mask];
+        }
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return m_mask + 1;
+    }
+
+private:
+    std::unique_ptr<T[]> m_cells;
+    size_t m_mask;
+    alignas(64) std::atomic<size_t> m_tail{0}; // Next position the producer writes
+    size_t m_head_cache = 0; // Producer's last view of m_head, so a push rarely touches the consumer's cache line
+    alignas(64) std::atomic<size_t> m_head{0}; // Next position the consumer reads
+};
+
+
+#endif //RAPIDCDH_SPSCRING_H
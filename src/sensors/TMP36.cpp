@@ -1,21 +1,54 @@
 #include "TMP36.h"
 
 #include "ADS7828.h"
+#include "ADS7828Sampler.h"
 #include "../globals.h"
 
-TMP36::TMP36(ADS7828* sensor, int channel) {
-	voltageAtZero = 0.5;
-	voltagePerDegree = 0.01;
+namespace {
+	// using V = vAtZero + T * vPerDeg
+	constexpr double VOLTAGE_AT_ZERO = 0.5;
+	constexpr double VOLTAGE_PER_DEGREE = 0.01;
+
+	constexpr conversion::LookupTable buildTable(double referenceVoltage) {
+		return conversion::LookupTable([referenceVoltage](double code) {
+			return (code * referenceVoltage / (1 << 12) - VOLTAGE_AT_ZERO) / VOLTAGE_PER_DEGREE;
+		});
+	}
+
+	constexpr conversion::LookupTable DEFAULT_TABLE = buildTable(ADS7828::DEFAULT_REFERENCE_VOLTAGE);
+
+	conversion::LookupTable tableFor(double voltsPerCode) {
+		double referenceVoltage = voltsPerCode * (1 << 12);
+		return referenceVoltage == ADS7828::DEFAULT_REFERENCE_VOLTAGE ? DEFAULT_TABLE : buildTable(referenceVoltage);
+	}
+}
+
+TMP36::TMP36(ADS7828* sensor, int channel) : table(tableFor(sensor->parseRawVoltage(1))) {
 	this->sensor = sensor;
 	this->channel = channel;
 }
 
+TMP36::TMP36(ADS7828Sampler* sampler, int channel) : table(tableFor(sampler->voltage(1))) {
+	this->sampler = sampler;
+	this->channel = channel;
+}
+
 Status TMP36::getTemperature(double& value) {
-	// using V = vAtZero + T * vPerDeg
-	double voltage = 1;
-	Status s = sensor->readChannelCommonAnode(channel, value);
+	uint16_t raw = 0;
+	Status s;
+	if (sampler) {
+		ADS7828Sampler::Sample sample{};
+		s = sampler->latest(channel, sample);
+		raw = sample.raw;
+	} else {
+		s = sensor->readChannelCommonAnodeRaw(channel, raw);
+	}
 	if (s == SUCCESS) {
-		value = (voltage - voltageAtZero) / voltagePerDegree;
+		value = table(raw);
 	}
 	return s;
+}
+
+void TMP36::parseTemperatures(std::span<const uint16_t> raw, std::span<float> values) {
+	conversion::convert(raw, table, values);
 }
\ No newline at end of file
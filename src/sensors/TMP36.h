@@ -1,18 +1,28 @@
 #ifndef RAPID_CDH_TMP36_H
 #define RAPID_CDH_TMP36_H
 
+#include <cstdint>
+#include <span>
+
 #include "../globals.h"
+#include "LookupTable.h"
 
 class ADS7828;
+class ADS7828Sampler;
 
 class TMP36 {
 public:
     TMP36(ADS7828* sensor, int channel);
+    // Converts the channel's latest sample from sampler rather than reading the ADC
+    TMP36(ADS7828Sampler* sampler, int channel);
     [[nodiscard]] Status getTemperature(double& value);
+    // Converts raw ADC codes from this sensor's channel, e.g. drained from a sampler, to degrees C
+    void parseTemperatures(std::span<const uint16_t> raw, std::span<float> values);
 private:
-    double voltageAtZero;
-    double voltagePerDegree;
-    ADS7828* sensor;
+    ADS7828* sensor = nullptr;
+    ADS7828Sampler* sampler = nullptr;
+    // ADC code to degrees C: built at compile time for the ADS7828's default reference, otherwise at construction
+    conversion::LookupTable table;
     int channel;
 };
 
@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include "../globals.h"
+#include "SpiBackend.h"
 
 class UM7 {
 public:
@@ -138,7 +139,7 @@ public:
 private:
     uint8_t m_channel;
     uint32_t m_speed;
-    int32_t m_spi;
+    SpiBackend* m_spi; // The backend current at construction
 
     static constexpr uint8_t CHANNEL = 1; // Chip select (0 or 1)
     static constexpr uint8_t OP_LEN  = 6; // Number of bytes per SPI operation
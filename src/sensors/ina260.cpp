@@ -1,40 +1,181 @@
 #include "ina260.h"
 
+#include <array>
+
+#include "Gpio.h"
+
 using namespace ina260;
 
+namespace {
+	constexpr uint16_t MANUFACTURER_TI = 0x5449;
+	constexpr uint16_t CONVERSION_READY_ALERT = 1 << 10;
+}
+
 //public
-Ina260::Ina260(const int devid):c_reg(0x01),v_reg(0x02),p_reg(0x03)
+Ina260::Ina260(const int devid, const char* device) : i2c(device, static_cast<uint8_t>(devid))
 {
-	fd = wiringPiI2CSetup(devid);
-	if(fd == -1) {std::cout<<"Not open device"<<std::endl; exit(0);} 
 }
-double
-Ina260::readVoltage_mV()
+
+Ina260::~Ina260()
 {
-	int v_data = wiringPiI2CReadReg16(fd, v_reg);
-	v_data = littleEndian(v_data);
-	return (double)v_data * 1.25;
+	(void) disableConversionReady();
 }
-double 
-Ina260::readCurrent_mA()
+
+Status
+Ina260::init()
 {
-	int c_data = wiringPiI2CReadReg16(fd, c_reg);
-	c_data = littleEndian(c_data);
-	return (double)c_data * 1.25;	
+	if (!i2c.is_open()) {
+		return I2C_SETUP_FAILURE;
+	}
+	uint16_t id;
+	if (readRegister(MANUFACTURER_ID, id) != SUCCESS) {
+		return I2C_READ_FAILURE;
+	}
+	return id == MANUFACTURER_TI ? SUCCESS : I2C_BAD_DATA;
 }
-double
-Ina260::readPower_mW()
+
+Status
+Ina260::getVoltage_mV(double& value)
 {
-	int p_data = wiringPiI2CReadReg16(fd, p_reg);
-	p_data = littleEndian(p_data);
-	return (double)p_data * 10;
+	uint16_t raw;
+	Status s = readRegister(BUS_VOLTAGE, raw);
+	if (s == SUCCESS) {
+		value = raw * 1.25;
+	}
+	return s;
+}
+
+Status
+Ina260::getCurrent_mA(double& value)
+{
+	uint16_t raw;
+	Status s = readRegister(CURRENT, raw);
+	if (s == SUCCESS) {
+		value = static_cast<int16_t>(raw) * 1.25; // signed
+	}
+	return s;
+}
+
+Status
+Ina260::getPower_mW(double& value)
+{
+	uint16_t raw;
+	Status s = readRegister(POWER, raw);
+	if (s == SUCCESS) {
+		value = raw * 10.0;
+	}
+	return s;
+}
+
+Status
+Ina260::getSnapshot(Snapshot& snapshot)
+{
+	if (!i2c.is_open()) {
+		return I2C_SETUP_FAILURE;
+	}
+	std::array<uint8_t, 3> regs{CURRENT, BUS_VOLTAGE, POWER};
+	std::array<uint16_t, 3> raw;
+	if (i2c.read_regs16(regs, raw) != SUCCESS) {
+		return I2C_READ_FAILURE;
+	}
+	snapshot = parse(raw[0], raw[1], raw[2]);
+	return SUCCESS;
+}
+
+Status
+Ina260::enableConversionReady(int alertPin)
+{
+	if (!i2c.is_open()) {
+		return I2C_SETUP_FAILURE;
+	}
+	std::lock_guard<std::mutex> alertLock(alertMutex);
+	// The handler on the old pin captures this; Mask/Enable is written again below, so its failure does not matter
+	(void) stopAlerts();
+	{
+		std::lock_guard<std::mutex> lock(readyMutex);
+		consumed = alerts;
+	}
+	Status s = gpio::on_falling_edge(alertPin, [this]() {
+		{
+			std::lock_guard<std::mutex> lock(readyMutex);
+			alerts++;
+		}
+		readyChanged.notify_all();
+	});
+	if (s != SUCCESS) {
+		return s;
+	}
+	// Reading Mask/Enable releases an alert left over from before, so the next conversion gives a fresh edge
+	uint16_t unused;
+	if (i2c.write_reg16(MASK_ENABLE, CONVERSION_READY_ALERT) != SUCCESS || readRegister(MASK_ENABLE, unused) != SUCCESS) {
+		(void) gpio::on_falling_edge(alertPin, nullptr);
+		return I2C_WRITE_FAILURE;
+	}
+	this->alertPin.store(alertPin);
+	return SUCCESS;
+}
+
+Status
+Ina260::waitForSnapshot(Snapshot& snapshot, std::chrono::milliseconds timeout)
+{
+	if (alertPin < 0) {
+		return FAILURE;
+	}
+	{
+		std::unique_lock<std::mutex> lock(readyMutex);
+		if (!readyChanged.wait_for(lock, timeout, [this]() { return alerts != consumed; })) {
+			return FAILURE;
+		}
+		consumed = alerts;
+	}
+
+	// Mask/Enable first, which releases ALERT, then the conversion, all in one transaction
+	std::array<uint8_t, 4> regs{MASK_ENABLE, CURRENT, BUS_VOLTAGE, POWER};
+	std::array<uint16_t, 4> raw;
+	if (i2c.read_regs16(regs, raw) != SUCCESS) {
+		return I2C_READ_FAILURE;
+	}
+	snapshot = parse(raw[1], raw[2], raw[3]);
+	return SUCCESS;
+}
+
+Status
+Ina260::disableConversionReady()
+{
+	std::lock_guard<std::mutex> alertLock(alertMutex);
+	return stopAlerts();
 }
 
 // private
-short int 
-Ina260::littleEndian(short x){
-	// little endian each 2 bytes
-	short int swap;
-	swap=((x & 0xff) << 8 | ((x >> 8) & 0xff));
-	return swap;
+Status
+Ina260::stopAlerts()
+{
+	int pin = alertPin.exchange(-1);
+	if (pin < 0) {
+		return SUCCESS;
+	}
+	(void) gpio::on_falling_edge(pin, nullptr);
+	if (i2c.write_reg16(MASK_ENABLE, 0) != SUCCESS) {
+		return I2C_WRITE_FAILURE;
+	}
+	return SUCCESS;
+}
+
+Ina260::Snapshot
+Ina260::parse(uint16_t current, uint16_t busVoltage, uint16_t power)
+{
+	return {busVoltage * 1.25, static_cast<int16_t>(current) * 1.25, power * 10.0};
+}
+
+// registers are sent MSB first
+Status
+Ina260::readRegister(Registers reg, uint16_t& value)
+{
+	if (!i2c.is_open()) {
+		return I2C_SETUP_FAILURE;
+	}
+	if (i2c.read_reg16(static_cast<uint8_t>(reg), value) != SUCCESS) {
+		return I2C_READ_FAILURE;
+	}
+	return SUCCESS;
 }
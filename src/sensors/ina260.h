@@ -1,26 +1,80 @@
 #ifndef INA260
 #define INA260
 
-#include <iostream>
-#include <stdlib.h>
-#include <wiringPi.h>
-#include <wiringPiI2C.h>
-#include <errno.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "../globals.h"
+#include "I2CDevice.h"
+
 namespace ina260{
+// INA260 power monitor with its integrated shunt. Readings are returned in mV, mA and mW, like INA219's.
+// In conversion-ready mode the device pulls its ALERT pin low as each conversion completes, and waitForSnapshot sleeps
+// until then instead of polling the bus
 class Ina260
 {
-private:
-	const int v_reg;
-	const int c_reg;
-	const int p_reg;
-//	const int config_reg;
-	int fd;
-	short int littleEndian(short x);
 public:
-	Ina260(const int devid);
-	double readVoltage_mV();
-	double readCurrent_mA();
-	double readPower_mW();
+	enum Registers {
+		CONFIGURATION = 0x00,
+		CURRENT = 0x01,
+		BUS_VOLTAGE = 0x02,
+		POWER = 0x03,
+		MASK_ENABLE = 0x06,
+		ALERT_LIMIT = 0x07,
+		MANUFACTURER_ID = 0xFE,
+		DIE_ID = 0xFF
+	};
+
+	// One conversion's readings
+	struct Snapshot {
+		double voltage_mV;
+		double current_mA;
+		double power_mW;
+	};
+
+	explicit Ina260(const int devid, const char* device = constants::I2C_DEV_1);
+	// Stops conversion-ready mode if it is on
+	~Ina260();
+
+	Ina260(const Ina260&) = delete;
+	Ina260& operator=(const Ina260&) = delete;
+
+	// I2C_SETUP_FAILURE if the bus could not be opened, I2C_BAD_DATA if the device does not identify as an INA260
+	[[nodiscard]] Status init();
+
+	[[nodiscard]] Status getVoltage_mV(double& value);
+	[[nodiscard]] Status getCurrent_mA(double& value);
+	[[nodiscard]] Status getPower_mW(double& value);
+	// All three in one transaction, so they come from the same conversion unless one completes part way through
+	[[nodiscard]] Status getSnapshot(Snapshot& snapshot);
+
+	// Enables the conversion-ready alert and listens for it on alertPin, which must be wired to ALERT. Stops listening on
+	// the previous pin first if it was already on
+	[[nodiscard]] Status enableConversionReady(int alertPin);
+	// Sleeps until a conversion completes that has not been waited for, then reads it. Conversions that complete while
+	// nobody waits are not queued: the next wait returns the latest at once. FAILURE if conversion-ready mode is off or
+	// nothing arrives within timeout
+	[[nodiscard]] Status waitForSnapshot(Snapshot& snapshot, std::chrono::milliseconds timeout);
+	[[nodiscard]] Status disableConversionReady();
+
+private:
+	static Snapshot parse(uint16_t current, uint16_t busVoltage, uint16_t power);
+	// Clears the handler on alertPin and the alert; alertMutex must be held
+	Status stopAlerts();
+	Status readRegister(Registers reg, uint16_t& value);
+
+	I2CDevice i2c;
+	// Held while conversion-ready mode is switched on or off. Not readyMutex: the GPIO layer runs the handler, which
+	// takes readyMutex, under its own lock, and takes that lock to replace the handler
+	std::mutex alertMutex;
+	std::atomic<int> alertPin = -1; // -1 when conversion-ready mode is off
+	std::mutex readyMutex;
+	std::condition_variable readyChanged;
+	uint64_t alerts = 0;  // falling edges seen on alertPin
+	uint64_t consumed = 0; // alerts when waitForSnapshot last returned
 };
 }	// enf namespace ina260
 #endif
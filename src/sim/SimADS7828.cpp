@@ -0,0 +1,67 @@
+#include "SimADS7828.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr uint8_t SINGLE_ENDED = 0x80;
+}
+
+SimADS7828::SimADS7828(double reference_voltage, uint64_t seed)
+    : m_reference_voltage(reference_voltage), m_rng(seed) {}
+
+void SimADS7828::set_voltage(int channel, double volts) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_inputs.at(channel) = volts;
+}
+
+void SimADS7828::set_noise(double volts_rms) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_noise = volts_rms;
+}
+
+bool SimADS7828::write(std::span<const uint8_t> data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!data.empty()) {
+        m_cmd = data.back(); // Each byte is a whole command; the last one written stands
+    }
+    return true;
+}
+
+bool SimADS7828::read(std::span<uint8_t> data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (size_t i = 0; i + 1 < data.size(); i += 2) {
+        uint16_t value = convert();
+        data[i] = static_cast<uint8_t>(value >> 8);
+        data[i + 1] = static_cast<uint8_t>(value);
+    }
+    if (data.size() % 2 != 0) {
+        data.back() = 0;
+    }
+    return true;
+}
+
+uint64_t SimADS7828::conversions() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_conversions;
+}
+
+// Command bits 6-4 are C2 C1 C0. Single-ended, channel 2k is C = k and channel 2k + 1 is C = 4 + k; differential,
+// C1 C0 pick the pair and C2 makes the odd channel the positive input
+uint16_t SimADS7828::convert() {
+    uint8_t c = (m_cmd >> 4) & 0b111;
+    double volts;
+    if (m_cmd & SINGLE_ENDED) {
+        volts = m_inputs[((c & 0b11) << 1) | (c >> 2)];
+    } else {
+        int positive = 2 * (c & 0b11) + (c >> 2);
+        volts = m_inputs[positive] - m_inputs[positive ^ 1];
+    }
+    if (m_noise > 0) {
+        volts += std::normal_distribution<double>(0, m_noise)(m_rng);
+    }
+
+    m_conversions++;
+    double code = std::round(volts / m_reference_voltage * 4096);
+    return static_cast<uint16_t>(std::clamp(code, 0.0, 4095.0));
+}
@@ -0,0 +1,42 @@
+#ifndef RAPIDCDH_SIMADS7828_H
+#define RAPIDCDH_SIMADS7828_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <span>
+
+#include "SimI2CBackend.h"
+
+// ADS7828 register model: a written command byte selects the input, and every 2 bytes read are a fresh 12-bit
+// conversion of it, MSB first. Differential inputs read zero when negative, as the converter is unipolar.
+// Addresses are 0x48 to 0x4B
+class SimADS7828 : public SimI2CDevice {
+public:
+    explicit SimADS7828(double reference_voltage = 2.5, uint64_t seed = 1);
+
+    void set_voltage(int channel, double volts);
+    // Gaussian noise added to every conversion, in volts RMS
+    void set_noise(double volts_rms);
+
+    [[nodiscard]] bool write(std::span<const uint8_t> data) override;
+    [[nodiscard]] bool read(std::span<uint8_t> data) override;
+
+    // Conversions read so far
+    [[nodiscard]] uint64_t conversions() const;
+
+private:
+    uint16_t convert();
+
+    mutable std::mutex m_mutex;
+    double m_reference_voltage;
+    std::array<double, 8> m_inputs{};
+    double m_noise = 0;
+    std::mt19937_64 m_rng;
+    uint8_t m_cmd = 0;
+    uint64_t m_conversions = 0;
+};
+
+
+#endif //RAPIDCDH_SIMADS7828_H
@@ -0,0 +1,70 @@
+#include "SimGpio.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+#include "../sensors/Gpio.h"
+
+namespace {
+    std::array<std::atomic<bool>, gpio::PINS> levels{};
+    std::array<std::atomic<uint64_t>, gpio::PINS> write_counts{};
+
+    std::mutex inputs_mutex;
+    std::array<bool, gpio::PINS> inputs = [] {
+        std::array<bool, gpio::PINS> high;
+        high.fill(true);
+        return high;
+    }();
+    std::array<std::function<void()>, gpio::PINS> handlers;
+
+    bool valid(int pin) {
+        return pin >= 0 && pin < gpio::PINS;
+    }
+}
+
+namespace gpio {
+    void set_output(int pin) {
+        write(pin, false);
+    }
+
+    void write(int pin, bool high) {
+        if (valid(pin)) {
+            levels[pin].store(high, std::memory_order_relaxed);
+            write_counts[pin].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Status on_falling_edge(int pin, std::function<void()> handler) {
+        if (!valid(pin)) {
+            return INVALID_INPUT;
+        }
+        std::lock_guard<std::mutex> lock(inputs_mutex);
+        handlers[pin] = std::move(handler);
+        return SUCCESS;
+    }
+}
+
+namespace sim_gpio {
+    bool level(int pin) {
+        return valid(pin) && levels[pin].load(std::memory_order_relaxed);
+    }
+
+    uint64_t writes(int pin) {
+        return valid(pin) ? write_counts[pin].load(std::memory_order_relaxed) : 0;
+    }
+
+    // The handler runs under the lock, as on the target, so replacing it waits for a call in progress
+    void set_input(int pin, bool high) {
+        if (!valid(pin)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(inputs_mutex);
+        bool falling = inputs[pin] && !high;
+        inputs[pin] = high;
+        if (falling && handlers[pin]) {
+            handlers[pin]();
+        }
+    }
+}
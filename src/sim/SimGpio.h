@@ -0,0 +1,19 @@
+#ifndef RAPIDCDH_SIMGPIO_H
+#define RAPIDCDH_SIMGPIO_H
+
+#include <cstdint>
+
+// The simulation build's GPIO: the levels the drivers set, for tests to inspect, and inputs that models or tests drive
+namespace sim_gpio {
+    // False for pins never driven high or out of range
+    [[nodiscard]] bool level(int pin);
+    // Writes to the pin so far, e.g. to count RTD excitation pulses
+    [[nodiscard]] uint64_t writes(int pin);
+
+    // Drives an input, as a device's alert line would. A high to low change calls the pin's gpio::on_falling_edge
+    // handler on the calling thread. Inputs idle high, as pulled up
+    void set_input(int pin, bool high);
+}
+
+
+#endif //RAPIDCDH_SIMGPIO_H
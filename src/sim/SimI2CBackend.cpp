@@ -0,0 +1,85 @@
+#include "SimI2CBackend.h"
+
+#include <utility>
+
+#include "SimTiming.h"
+
+SimI2CBackend::SimI2CBackend(Config config) : m_config(config), m_rng(config.seed) {}
+
+SimI2CBackend::SimI2CBackend() : SimI2CBackend(Config{}) {}
+
+void SimI2CBackend::attach(uint8_t address, std::shared_ptr<SimI2CDevice> device) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_devices[address & 0x7F] = std::move(device);
+}
+
+void SimI2CBackend::set_clock(uint32_t clock_hz) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config.clock_hz = clock_hz;
+}
+
+void SimI2CBackend::set_overhead(std::chrono::nanoseconds overhead) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config.overhead = overhead;
+}
+
+void SimI2CBackend::set_nack_rate(double rate) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config.nack_rate = rate;
+}
+
+void SimI2CBackend::fail_next(uint32_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_fail_next = count;
+}
+
+bool SimI2CBackend::is_open() const {
+    return true;
+}
+
+bool SimI2CBackend::transfer(std::span<const Segment> segments) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_transfers++;
+    bool fail = m_fail_next > 0;
+    if (fail) {
+        m_fail_next--;
+    }
+    std::bernoulli_distribution nack(m_config.nack_rate);
+
+    // Each segment is a (repeated) start, the address byte and its data bytes, every byte with its ACK bit, then the
+    // stop at the end. A NACKed segment ends after its address byte
+    uint64_t bits = 1;
+    bool ok = true;
+    for (const Segment& s : segments) {
+        bits += 1 + 9;
+        const std::shared_ptr<SimI2CDevice>& device = m_devices[s.address & 0x7F];
+        if (fail || !device || (m_config.nack_rate > 0 && nack(m_rng))) {
+            ok = false;
+            break;
+        }
+        bits += 9 * s.len;
+        if (!(s.read ? device->read({s.data, s.len}) : device->write({s.data, s.len}))) {
+            ok = false;
+            break;
+        }
+    }
+    if (!ok) {
+        m_failures++;
+    }
+    std::chrono::nanoseconds duration = m_config.overhead +
+                                        std::chrono::nanoseconds(bits * 1000000000 / m_config.clock_hz);
+    lock.unlock();
+
+    sim::busy_wait(duration);
+    return ok;
+}
+
+uint64_t SimI2CBackend::transfers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_transfers;
+}
+
+uint64_t SimI2CBackend::failures() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_failures;
+}
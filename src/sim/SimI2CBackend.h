@@ -0,0 +1,70 @@
+#ifndef RAPIDCDH_SIMI2CBACKEND_H
+#define RAPIDCDH_SIMI2CBACKEND_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+
+#include "../sensors/I2CBackend.h"
+
+// A device model on a simulated I2C bus. Each call is one segment of a transfer addressed to the device. Models are
+// called from the bus thread, and lock themselves so tests can change their inputs from any other
+class SimI2CDevice {
+public:
+    virtual ~SimI2CDevice() = default;
+
+    // Returning false NACKs the segment, which ends the transfer
+    [[nodiscard]] virtual bool write(std::span<const uint8_t> data) = 0;
+    [[nodiscard]] virtual bool read(std::span<uint8_t> data) = 0;
+};
+
+// An I2C bus with device models on it in place of hardware. Each transfer takes as long as its bits would at the
+// configured clock, plus a fixed overhead for the syscall and driver. Faults can be injected: segments to an address
+// with no device are NACKed, as on a real bus, and so are a random fraction of all segments and every segment of the
+// next few transfers.
+// Hand one to I2CBus::attach to put the drivers on it
+class SimI2CBackend : public I2CBackend {
+public:
+    struct Config {
+        uint32_t clock_hz = 400000;
+        // Per transfer, on top of the bits on the wire. Measure a real I2C_RDWR on the target and set it to match
+        std::chrono::nanoseconds overhead{std::chrono::microseconds(20)};
+        double nack_rate = 0; // Chance that any one segment is NACKed
+        uint64_t seed = 1;
+    };
+
+    explicit SimI2CBackend(Config config);
+    SimI2CBackend();
+
+    // Puts device at the 7-bit address, replacing whatever was there; nullptr removes it
+    void attach(uint8_t address, std::shared_ptr<SimI2CDevice> device);
+
+    void set_clock(uint32_t clock_hz);
+    void set_overhead(std::chrono::nanoseconds overhead);
+    void set_nack_rate(double rate);
+    // Fails the next count transfers on their first segment
+    void fail_next(uint32_t count);
+
+    [[nodiscard]] bool is_open() const override;
+    [[nodiscard]] bool transfer(std::span<const Segment> segments) override;
+
+    // Transfers run, and those that failed
+    [[nodiscard]] uint64_t transfers() const;
+    [[nodiscard]] uint64_t failures() const;
+
+private:
+    mutable std::mutex m_mutex;
+    Config m_config;
+    std::mt19937_64 m_rng;
+    std::array<std::shared_ptr<SimI2CDevice>, 128> m_devices;
+    uint32_t m_fail_next = 0;
+    uint64_t m_transfers = 0;
+    uint64_t m_failures = 0;
+};
+
+
+#endif //RAPIDCDH_SIMI2CBACKEND_H
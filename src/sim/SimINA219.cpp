@@ -0,0 +1,129 @@
+#include "SimINA219.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    enum Registers : uint8_t {
+        CONFIGURATION = 0,
+        SHUNT_VOLTAGE = 1,
+        BUS_VOLTAGE = 2,
+        POWER = 3,
+        CURRENT = 4,
+        CALIBRATION = 5
+    };
+
+    constexpr uint16_t DEFAULT_CONFIG = 0x399F;
+    constexpr uint16_t CONFIG_RESET = 1 << 15;
+
+    // ADC conversion time for a BADC/SADC setting: 9 to 12 bits, then 2 to 128 averaged 12-bit samples
+    std::chrono::microseconds adc_time(uint16_t setting) {
+        static constexpr std::array<int, 4> bits{84, 148, 276, 532};
+        static constexpr std::array<int, 8> averaged{532, 1060, 2130, 4260, 8510, 17020, 34050, 68100};
+        return std::chrono::microseconds(setting & 0b1000 ? averaged[setting & 0b111] : bits[setting & 0b11]);
+    }
+}
+
+SimINA219::SimINA219(uint64_t seed) : m_rng(seed) {
+    reset();
+}
+
+void SimINA219::set_shunt_voltage(double volts) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shunt_voltage = volts;
+}
+
+void SimINA219::set_bus_voltage(double volts) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bus_voltage = volts;
+}
+
+void SimINA219::set_noise(double shunt_volts_rms, double bus_volts_rms) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shunt_noise = shunt_volts_rms;
+    m_bus_noise = bus_volts_rms;
+}
+
+void SimINA219::reset() {
+    m_config = DEFAULT_CONFIG;
+    m_calibration = 0;
+    write_register(CONFIGURATION, DEFAULT_CONFIG);
+}
+
+// Latches a new result if a conversion has completed since the last one
+void SimINA219::update(sim::Clock::time_point now) {
+    uint64_t completed = m_timer.completed(now);
+    if (completed == m_latched) {
+        return;
+    }
+    m_latched = completed;
+
+    uint16_t mode = m_config & 0b111;
+    if (mode & 0b001) {
+        double volts = m_shunt_voltage;
+        if (m_shunt_noise > 0) {
+            volts += std::normal_distribution<double>(0, m_shunt_noise)(m_rng);
+        }
+        double range = 4000 << ((m_config >> 11) & 0b11); // 40 mV to 320 mV in 10 uV steps
+        m_shunt = static_cast<int16_t>(std::clamp(std::round(volts / 10e-6), -range, range));
+    }
+    if (mode & 0b010) {
+        double volts = m_bus_voltage;
+        if (m_bus_noise > 0) {
+            volts += std::normal_distribution<double>(0, m_bus_noise)(m_rng);
+        }
+        double range = m_config & (1 << 13) ? 8000 : 4000; // 32 V or 16 V in 4 mV steps
+        m_bus = static_cast<uint16_t>(std::clamp(std::round(volts / 4e-3), 0.0, range));
+    }
+}
+
+uint16_t SimINA219::read_register(uint8_t reg) {
+    update(sim::Clock::now());
+    int32_t current = m_shunt * m_calibration / 4096;
+    int32_t power = std::abs(current) * m_bus / 5000;
+    m_overflow = current < INT16_MIN || current > INT16_MAX || power > UINT16_MAX;
+
+    switch (reg) {
+        case CONFIGURATION:
+            return m_config;
+        case SHUNT_VOLTAGE:
+            return static_cast<uint16_t>(m_shunt);
+        case BUS_VOLTAGE:
+            return static_cast<uint16_t>(m_bus << 3 | (m_latched > m_seen) << 1 | m_overflow);
+        case POWER:
+            m_seen = m_latched;
+            return static_cast<uint16_t>(std::min<int32_t>(power, UINT16_MAX));
+        case CURRENT:
+            return static_cast<uint16_t>(std::clamp<int32_t>(current, INT16_MIN, INT16_MAX));
+        case CALIBRATION:
+            return m_calibration;
+        default:
+            return 0;
+    }
+}
+
+void SimINA219::write_register(uint8_t reg, uint16_t value) {
+    if (reg == CALIBRATION) {
+        m_calibration = value & 0xFFFE; // Bit 0 is fixed at 0
+    } else if (reg == CONFIGURATION) {
+        if (value & CONFIG_RESET) {
+            reset();
+            return;
+        }
+        // Every configuration write restarts the ADC; the triggered modes convert once
+        m_config = value;
+        uint16_t mode = value & 0b111;
+        sim::Clock::duration period = sim::Clock::duration::zero();
+        if (mode & 0b001) {
+            period += adc_time((value >> 3) & 0xF);
+        }
+        if (mode & 0b010) {
+            period += adc_time((value >> 7) & 0xF);
+        }
+        m_timer.restart(sim::Clock::now(), period, mode & 0b100);
+        m_latched = 0;
+        m_seen = 0;
+    }
+}
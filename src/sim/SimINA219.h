@@ -0,0 +1,48 @@
+#ifndef RAPIDCDH_SIMINA219_H
+#define RAPIDCDH_SIMINA219_H
+
+#include <cstdint>
+#include <random>
+
+#include "SimRegisterDevice.h"
+#include "SimTiming.h"
+
+// INA219 register model. Conversions run on the ADC timing the configuration selects, and the readings only change
+// when one completes: CNVR in the bus voltage register is set by each and cleared by reading power, as on the device.
+// The shunt reading saturates at the PGA range and the bus reading at the bus range. Current and power follow the
+// calibration register the way the device computes them. Addresses are 0x40 to 0x4F
+class SimINA219 : public SimRegisterDevice {
+public:
+    explicit SimINA219(uint64_t seed = 1);
+
+    void set_shunt_voltage(double volts);
+    void set_bus_voltage(double volts);
+    // Gaussian noise added to each conversion, in volts RMS
+    void set_noise(double shunt_volts_rms, double bus_volts_rms);
+
+protected:
+    uint16_t read_register(uint8_t reg) override;
+    void write_register(uint8_t reg, uint16_t value) override;
+
+private:
+    void reset();
+    void update(sim::Clock::time_point now);
+
+    double m_shunt_voltage = 0;
+    double m_bus_voltage = 0;
+    double m_shunt_noise = 0;
+    double m_bus_noise = 0;
+    std::mt19937_64 m_rng;
+
+    uint16_t m_config;
+    uint16_t m_calibration;
+    sim::ConversionTimer m_timer;
+    uint64_t m_latched = 0; // Conversions whose result is in the registers
+    uint64_t m_seen = 0;    // Conversions completed when power was last read
+    int16_t m_shunt = 0;
+    uint16_t m_bus = 0;     // In 4 mV steps
+    bool m_overflow = false;
+};
+
+
+#endif //RAPIDCDH_SIMINA219_H
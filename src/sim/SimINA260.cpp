@@ -0,0 +1,187 @@
+#include "SimINA260.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+#include "SimGpio.h"
+
+namespace {
+    enum Registers : uint8_t {
+        CONFIGURATION = 0x00,
+        CURRENT = 0x01,
+        BUS_VOLTAGE = 0x02,
+        POWER = 0x03,
+        MASK_ENABLE = 0x06,
+        ALERT_LIMIT = 0x07,
+        MANUFACTURER_ID = 0xFE,
+        DIE_ID = 0xFF
+    };
+
+    constexpr uint16_t DEFAULT_CONFIG = 0x6127;
+    constexpr uint16_t CONFIG_RESET = 1 << 15;
+    constexpr uint16_t CVRF = 1 << 3;
+    constexpr uint16_t CNVR = 1 << 10; // Conversion-ready alert enable
+
+    constexpr std::array<int, 8> CONVERSION_US{140, 204, 332, 588, 1100, 2116, 4156, 8244};
+    constexpr std::array<int, 8> AVERAGES{1, 4, 16, 64, 128, 256, 512, 1024};
+}
+
+SimINA260::SimINA260(uint64_t seed) : m_rng(seed) {
+    reset();
+}
+
+SimINA260::~SimINA260() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_changed.notify_all();
+    if (m_alert_thread.joinable()) {
+        m_alert_thread.join();
+    }
+}
+
+void SimINA260::set_alert_pin(int pin) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_alert_pin = pin;
+    if (!m_alert_thread.joinable()) {
+        m_alert_thread = std::thread(&SimINA260::drive_alert, this);
+    }
+    m_changed.notify_all();
+}
+
+// Sleeps until each conversion completes and asserts ALERT for it if the alert is enabled
+void SimINA260::drive_alert() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        sim::Clock::time_point next = m_timer.next(sim::Clock::now());
+        if (next == sim::Clock::time_point::max()) {
+            m_changed.wait(lock);
+        } else {
+            m_changed.wait_until(lock, next);
+        }
+        if (m_stopping) {
+            return;
+        }
+
+        update(sim::Clock::now());
+        if ((m_mask_enable & (CNVR | CVRF)) == (CNVR | CVRF) && !m_alert_asserted) {
+            m_alert_asserted = true;
+            sim_gpio::set_input(m_alert_pin, false);
+        }
+    }
+}
+
+void SimINA260::set_current(double amps) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_current = amps;
+}
+
+void SimINA260::set_bus_voltage(double volts) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bus_voltage = volts;
+}
+
+void SimINA260::set_noise(double amps_rms, double volts_rms) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_current_noise = amps_rms;
+    m_bus_noise = volts_rms;
+}
+
+void SimINA260::reset() {
+    m_mask_enable = 0;
+    m_alert_limit = 0;
+    write_register(CONFIGURATION, DEFAULT_CONFIG);
+}
+
+void SimINA260::update(sim::Clock::time_point now) {
+    uint64_t completed = m_timer.completed(now);
+    if (completed == m_latched) {
+        return;
+    }
+    m_latched = completed;
+
+    uint16_t mode = m_config & 0b111;
+    if (mode & 0b001) {
+        double amps = m_current;
+        if (m_current_noise > 0) {
+            amps += std::normal_distribution<double>(0, m_current_noise)(m_rng);
+        }
+        m_current_reg = static_cast<int16_t>(std::clamp(std::round(amps / 1.25e-3), -32768.0, 32767.0));
+    }
+    if (mode & 0b010) {
+        double volts = m_bus_voltage;
+        if (m_bus_noise > 0) {
+            volts += std::normal_distribution<double>(0, m_bus_noise)(m_rng);
+        }
+        m_bus = static_cast<uint16_t>(std::clamp(std::round(volts / 1.25e-3), 0.0, 32767.0));
+    }
+    double watts = std::abs(m_current_reg * 1.25e-3) * (m_bus * 1.25e-3);
+    m_power = static_cast<uint16_t>(std::min(std::floor(watts / 10e-3), 65535.0));
+    m_mask_enable |= CVRF;
+}
+
+uint16_t SimINA260::read_register(uint8_t reg) {
+    update(sim::Clock::now());
+    switch (reg) {
+        case CONFIGURATION:
+            return m_config;
+        case CURRENT:
+            return static_cast<uint16_t>(m_current_reg);
+        case BUS_VOLTAGE:
+            return m_bus;
+        case POWER:
+            return m_power;
+        case MASK_ENABLE: {
+            uint16_t value = m_mask_enable;
+            m_mask_enable &= ~CVRF;
+            if (m_alert_asserted) {
+                m_alert_asserted = false;
+                sim_gpio::set_input(m_alert_pin, true);
+            }
+            return value;
+        }
+        case ALERT_LIMIT:
+            return m_alert_limit;
+        case MANUFACTURER_ID:
+            return 0x5449; // "TI"
+        case DIE_ID:
+            return 0x2270;
+        default:
+            return 0;
+    }
+}
+
+void SimINA260::write_register(uint8_t reg, uint16_t value) {
+    switch (reg) {
+        case CONFIGURATION: {
+            if (value & CONFIG_RESET) {
+                reset();
+                return;
+            }
+            m_config = value;
+            uint16_t mode = value & 0b111;
+            std::chrono::microseconds period{0};
+            if (mode & 0b001) {
+                period += std::chrono::microseconds(CONVERSION_US[(value >> 3) & 0b111]);
+            }
+            if (mode & 0b010) {
+                period += std::chrono::microseconds(CONVERSION_US[(value >> 6) & 0b111]);
+            }
+            m_timer.restart(sim::Clock::now(), period * AVERAGES[(value >> 9) & 0b111], mode & 0b100);
+            m_latched = 0;
+            m_changed.notify_all();
+            break;
+        }
+        case MASK_ENABLE:
+            m_mask_enable = static_cast<uint16_t>((value & 0xFC03) | (m_mask_enable & CVRF));
+            break;
+        case ALERT_LIMIT:
+            m_alert_limit = value;
+            break;
+        default:
+            break;
+    }
+}
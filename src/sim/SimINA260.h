@@ -0,0 +1,62 @@
+#ifndef RAPIDCDH_SIMINA260_H
+#define RAPIDCDH_SIMINA260_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <random>
+#include <thread>
+
+#include "SimRegisterDevice.h"
+#include "SimTiming.h"
+
+// INA260 register model, with its integrated shunt: current in 1.25 mA steps, bus voltage in 1.25 mV steps and power
+// in 10 mW steps. Conversions run on the conversion times and averaging the configuration selects; each completed
+// one sets CVRF in Mask/Enable, which reading that register clears. With an alert pin and the conversion-ready alert
+// enabled, ALERT is pulled low through sim_gpio as each conversion completes and released when Mask/Enable is read.
+// Addresses are 0x40 to 0x4F
+class SimINA260 : public SimRegisterDevice {
+public:
+    explicit SimINA260(uint64_t seed = 1);
+    ~SimINA260() override;
+
+    // Wires ALERT to a simulated GPIO input; a thread then drives it as conversions complete
+    void set_alert_pin(int pin);
+
+    void set_current(double amps);
+    void set_bus_voltage(double volts);
+    // Gaussian noise added to each conversion, in amps and volts RMS
+    void set_noise(double amps_rms, double volts_rms);
+
+protected:
+    uint16_t read_register(uint8_t reg) override;
+    void write_register(uint8_t reg, uint16_t value) override;
+
+private:
+    void reset();
+    void update(sim::Clock::time_point now);
+    void drive_alert();
+
+    double m_current = 0;
+    double m_bus_voltage = 0;
+    double m_current_noise = 0;
+    double m_bus_noise = 0;
+    std::mt19937_64 m_rng;
+
+    uint16_t m_config;
+    uint16_t m_mask_enable;
+    uint16_t m_alert_limit;
+    sim::ConversionTimer m_timer;
+    uint64_t m_latched = 0;
+    int16_t m_current_reg = 0;
+    uint16_t m_bus = 0;
+    uint16_t m_power = 0;
+
+    int m_alert_pin = -1;
+    bool m_alert_asserted = false;
+    bool m_stopping = false;
+    std::condition_variable m_changed; // Configuration changed or stopping, for the alert thread
+    std::thread m_alert_thread;
+};
+
+
+#endif //RAPIDCDH_SIMINA260_H
@@ -0,0 +1,48 @@
+#ifndef RAPIDCDH_SIMREGISTERDEVICE_H
+#define RAPIDCDH_SIMREGISTERDEVICE_H
+
+#include <cstdint>
+#include <mutex>
+#include <span>
+
+#include "SimI2CBackend.h"
+
+// The INA219/INA260 style of I2C device: 16-bit registers behind an 8-bit pointer. A write sets the pointer and, with
+// two more bytes, writes the register MSB first; a read returns the register the pointer is on, repeated for as many
+// bytes as are read. Subclasses model the registers, called with m_mutex held
+class SimRegisterDevice : public SimI2CDevice {
+public:
+    [[nodiscard]] bool write(std::span<const uint8_t> data) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (data.empty()) {
+            return true;
+        }
+        m_pointer = data[0];
+        if (data.size() >= 3) {
+            write_register(m_pointer, static_cast<uint16_t>(data[1] << 8 | data[2]));
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool read(std::span<uint8_t> data) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint16_t value = read_register(m_pointer);
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = static_cast<uint8_t>(i % 2 == 0 ? value >> 8 : value);
+        }
+        return true;
+    }
+
+protected:
+    virtual uint16_t read_register(uint8_t reg) = 0;
+    // Writes to read-only or missing registers are ignored, as the devices do
+    virtual void write_register(uint8_t reg, uint16_t value) = 0;
+
+    mutable std::mutex m_mutex;
+
+private:
+    uint8_t m_pointer = 0;
+};
+
+
+#endif //RAPIDCDH_SIMREGISTERDEVICE_H
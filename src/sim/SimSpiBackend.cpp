@@ -0,0 +1,85 @@
+#include "SimSpiBackend.h"
+
+#include <utility>
+
+#include "SimTiming.h"
+
+SimSpiBackend::SimSpiBackend(Config config) : m_config(config), m_rng(config.seed) {}
+
+SimSpiBackend::SimSpiBackend() : SimSpiBackend(Config{}) {}
+
+SimSpiBackend& SimSpiBackend::platform() {
+    static SimSpiBackend spi;
+    return spi;
+}
+
+SpiBackend& SpiBackend::platform() {
+    return SimSpiBackend::platform();
+}
+
+void SimSpiBackend::attach(uint8_t channel, std::shared_ptr<SimSpiDevice> device) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_devices.at(channel) = std::move(device);
+}
+
+void SimSpiBackend::set_overhead(std::chrono::nanoseconds overhead) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config.overhead = overhead;
+}
+
+void SimSpiBackend::set_fault_rate(double rate) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config.fault_rate = rate;
+}
+
+void SimSpiBackend::fail_next(uint32_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_fail_next = count;
+}
+
+bool SimSpiBackend::setup(uint8_t channel, uint32_t speed) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (channel >= CHANNELS || speed == 0) {
+        return false;
+    }
+    m_speed[channel] = speed;
+    return true;
+}
+
+bool SimSpiBackend::transfer(uint8_t channel, std::span<uint8_t> data) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (channel >= CHANNELS || m_speed[channel] == 0) {
+        return false; // Not set up
+    }
+    m_transfers++;
+    bool fail = m_fail_next > 0;
+    if (fail) {
+        m_fail_next--;
+    }
+    if (!fail && m_config.fault_rate > 0) {
+        fail = std::bernoulli_distribution(m_config.fault_rate)(m_rng);
+    }
+
+    const std::shared_ptr<SimSpiDevice>& device = m_devices[channel];
+    if (fail || !device) {
+        m_failures++;
+        return false;
+    }
+    device->transfer(data);
+    std::chrono::nanoseconds duration = m_config.overhead +
+                                        std::chrono::nanoseconds(data.size() * 8 * 1000000000ull / m_speed[channel]);
+    lock.unlock();
+
+    sim::busy_wait(duration);
+    return true;
+}
+
+uint64_t SimSpiBackend::transfers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_transfers;
+}
+
+uint64_t SimSpiBackend::failures() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_failures;
+}
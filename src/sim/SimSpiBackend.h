@@ -0,0 +1,69 @@
+#ifndef RAPIDCDH_SIMSPIBACKEND_H
+#define RAPIDCDH_SIMSPIBACKEND_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+
+#include "../sensors/SpiBackend.h"
+
+// A device model on a simulated SPI bus. Each call is one full-duplex transfer with its chip select asserted
+class SimSpiDevice {
+public:
+    virtual ~SimSpiDevice() = default;
+
+    // Replaces the bytes sent with the bytes the device clocks out
+    virtual void transfer(std::span<uint8_t> data) = 0;
+};
+
+// An SPI bus with device models on its two chip selects. Transfers take as long as their bits would at the speed the
+// channel was set up with, plus a fixed overhead for the syscall and driver. Faults can be injected: a random fraction
+// of transfers, or the next few, fail outright, and a transfer on a chip select with no device fails.
+// This is the platform backend in the simulation build, so SPI drivers find it without installing it
+class SimSpiBackend : public SpiBackend {
+public:
+    static constexpr size_t CHANNELS = 2;
+
+    struct Config {
+        // Per transfer, on top of the bits on the wire
+        std::chrono::nanoseconds overhead{std::chrono::microseconds(10)};
+        double fault_rate = 0;
+        uint64_t seed = 1;
+    };
+
+    explicit SimSpiBackend(Config config);
+    SimSpiBackend();
+
+    // The backend SpiBackend::current() falls back to in the simulation build
+    static SimSpiBackend& platform();
+
+    // Puts device on chip select channel, replacing whatever was there; nullptr removes it
+    void attach(uint8_t channel, std::shared_ptr<SimSpiDevice> device);
+
+    void set_overhead(std::chrono::nanoseconds overhead);
+    void set_fault_rate(double rate);
+    void fail_next(uint32_t count);
+
+    [[nodiscard]] bool setup(uint8_t channel, uint32_t speed) override;
+    [[nodiscard]] bool transfer(uint8_t channel, std::span<uint8_t> data) override;
+
+    [[nodiscard]] uint64_t transfers() const;
+    [[nodiscard]] uint64_t failures() const;
+
+private:
+    mutable std::mutex m_mutex;
+    Config m_config;
+    std::mt19937_64 m_rng;
+    std::array<std::shared_ptr<SimSpiDevice>, CHANNELS> m_devices;
+    std::array<uint32_t, CHANNELS> m_speed{}; // 0 until set up
+    uint32_t m_fail_next = 0;
+    uint64_t m_transfers = 0;
+    uint64_t m_failures = 0;
+};
+
+
+#endif //RAPIDCDH_SIMSPIBACKEND_H
@@ -0,0 +1,54 @@
+#ifndef RAPIDCDH_SIMTIMING_H
+#define RAPIDCDH_SIMTIMING_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace sim {
+    using Clock = std::chrono::steady_clock;
+
+    // Holds the calling thread for d. Spins, because the bus times being modelled are far shorter than a sleep can be
+    inline void busy_wait(Clock::duration d) {
+        Clock::time_point end = Clock::now() + d;
+        while (Clock::now() < end) {
+        }
+    }
+
+    // When an ADC's conversions complete. A continuous ADC converts back to back from the last restart; a triggered
+    // one converts once
+    class ConversionTimer {
+    public:
+        void restart(Clock::time_point now, Clock::duration period, bool continuous) {
+            m_start = now;
+            m_period = period;
+            m_continuous = continuous;
+        }
+
+        // Conversions completed since the last restart
+        [[nodiscard]] uint64_t completed(Clock::time_point now) const {
+            if (m_period <= Clock::duration::zero()) {
+                return 0; // Powered down
+            }
+            uint64_t n = static_cast<uint64_t>((now - m_start) / m_period);
+            return m_continuous ? n : std::min<uint64_t>(n, 1);
+        }
+
+        // When the next conversion after now completes; Clock::time_point::max() if none will
+        [[nodiscard]] Clock::time_point next(Clock::time_point now) const {
+            uint64_t n = completed(now);
+            if (m_period <= Clock::duration::zero() || (!m_continuous && n > 0)) {
+                return Clock::time_point::max();
+            }
+            return m_start + static_cast<int64_t>(n + 1) * m_period;
+        }
+
+    private:
+        Clock::time_point m_start{};
+        Clock::duration m_period{};
+        bool m_continuous = false;
+    };
+}
+
+
+#endif //RAPIDCDH_SIMTIMING_H
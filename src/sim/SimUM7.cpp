@@ -0,0 +1,75 @@
+#include "SimUM7.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "../sensors/UM7.h"
+
+SimUM7::SimUM7(uint64_t seed) : m_rng(seed) {
+    m_registers[UM7::GET_FW_REVISION] = 'S' << 24 | 'I' << 16 | 'M' << 8 | '1';
+}
+
+void SimUM7::set_register(uint8_t reg, uint32_t value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_registers[reg] = value;
+}
+
+void SimUM7::set_float(uint8_t reg, float value) {
+    set_register(reg, std::bit_cast<uint32_t>(value));
+}
+
+void SimUM7::set_noise(float rms) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_noise = rms;
+}
+
+uint32_t SimUM7::get_register(uint8_t reg) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_registers[reg];
+}
+
+uint64_t SimUM7::commands() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_commands;
+}
+
+// The processed gyro, accelerometer and magnetometer axes; the Euler angles and quaternion are packed integers
+bool SimUM7::noisy(uint8_t reg) {
+    return (reg >= UM7::DREG_GYRO_PROC_X && reg <= UM7::DREG_GYRO_PROC_Z) ||
+           (reg >= UM7::DREG_ACCEL_PROC_X && reg <= UM7::DREG_ACCEL_PROC_Z) ||
+           (reg >= UM7::DREG_MAG_PROC_X && reg <= UM7::DREG_MAG_PROC_Z);
+}
+
+void SimUM7::transfer(std::span<uint8_t> data) {
+    if (data.size() < 6) {
+        std::fill(data.begin(), data.end(), 0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint8_t reg = data[1];
+    if (data[0] == 0x01) {
+        if (reg >= UM7::GET_FW_REVISION) {
+            m_commands++;
+        } else if (reg < UM7::DREG_HEALTH) {
+            m_registers[reg] = static_cast<uint32_t>(data[2] << 24 | data[3] << 16 | data[4] << 8 | data[5]);
+        }
+        std::fill(data.begin(), data.end(), 0);
+        return;
+    }
+
+    uint32_t value = m_registers[reg];
+    if (m_noise > 0 && noisy(reg)) {
+        float noisy_value = std::bit_cast<float>(value) + std::normal_distribution<float>(0, m_noise)(m_rng);
+        value = std::bit_cast<uint32_t>(noisy_value);
+    }
+    if (reg == UM7::GET_FW_REVISION) {
+        m_commands++;
+    }
+    data[0] = 0;
+    data[1] = 0;
+    data[2] = static_cast<uint8_t>(value >> 24);
+    data[3] = static_cast<uint8_t>(value >> 16);
+    data[4] = static_cast<uint8_t>(value >> 8);
+    data[5] = static_cast<uint8_t>(value);
+}
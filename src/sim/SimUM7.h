@@ -0,0 +1,42 @@
+#ifndef RAPIDCDH_SIMUM7_H
+#define RAPIDCDH_SIMUM7_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <span>
+
+#include "SimSpiBackend.h"
+
+// UM7 register model over SPI. Each transfer is a read (0x00) or write (0x01) byte, a register address, and the
+// register's 32 bits MSB first, which a read clocks out in place of the bytes sent. Configuration registers hold what
+// is written; data registers hold what the test sets, with noise added to the processed sensor readings.
+// GET_FW_REVISION reads back the firmware revision; the other commands are counted and otherwise ignored
+class SimUM7 : public SimSpiDevice {
+public:
+    explicit SimUM7(uint64_t seed = 1);
+
+    void set_register(uint8_t reg, uint32_t value);
+    // Sets a data register that holds an IEEE-754 float, such as DREG_GYRO_PROC_X
+    void set_float(uint8_t reg, float value);
+    // Gaussian noise added to the processed gyro, accelerometer and magnetometer readings
+    void set_noise(float rms);
+
+    [[nodiscard]] uint32_t get_register(uint8_t reg) const;
+    [[nodiscard]] uint64_t commands() const;
+
+    void transfer(std::span<uint8_t> data) override;
+
+private:
+    static bool noisy(uint8_t reg);
+
+    mutable std::mutex m_mutex;
+    std::array<uint32_t, 256> m_registers{};
+    float m_noise = 0;
+    std::mt19937_64 m_rng;
+    uint64_t m_commands = 0;
+};
+
+
+#endif //RAPIDCDH_SIMUM7_H